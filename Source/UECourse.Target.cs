@@ -10,5 +10,7 @@ public class UECourseTarget : TargetRules
 		Type = TargetType.Game;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
 		ExtraModuleNames.Add("UECourse");
+		BuildEnvironment = TargetBuildEnvironment.Unique;
+		bWithPushModel = true;
 	}
 }
@@ -4,7 +4,13 @@
 #include "AICharacter.h"
 #include "CourseAIController.h"
 #include "../UI/CharacterWidget.h"
+#include "../Core/CourseDamageSubsystem.h"
+#include "../Core/CourseRewindSubsystem.h"
+#include "../UECourseCharacter.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/CapsuleComponent.h"
 
 // Sets default values
 AAICharacter::AAICharacter()
@@ -20,7 +26,23 @@ AAICharacter::AAICharacter()
 void AAICharacter::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	DefaultNetUpdateFrequency = NetUpdateFrequency;
+
+	if (UCourseSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UCourseSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->RegisterAI(this);
+	}
+}
+
+void AAICharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCourseSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UCourseSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->UnregisterAI(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -28,11 +50,53 @@ void AAICharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (HasAuthority())
+	{
+		CheckContact();
+	}
+}
+
+void AAICharacter::CheckContact()
+{
+	UCourseRewindSubsystem* RewindSubsystem = GetWorld()->GetSubsystem<UCourseRewindSubsystem>();
+
+	if (RewindSubsystem == nullptr)
+	{
+		return;
+	}
+
+	// The player capsules generate no overlap events, so contact is a sweep along the spider's capsule axis
+	const UCapsuleComponent* Capsule = GetCapsuleComponent();
+	const FVector Axis = Capsule->GetUpVector() * FMath::Max(Capsule->GetScaledCapsuleHalfHeight() - Capsule->GetScaledCapsuleRadius(), 0.f);
+	const FVector Center = Capsule->GetComponentLocation();
+
+	TArray<ACharacter*> Hits;
+	RewindSubsystem->SweepFighters(this, Center - Axis, Center + Axis, Capsule->GetScaledCapsuleRadius(), GetWorld()->GetTimeSeconds(), Hits);
+
+	for (ACharacter* Hit : Hits)
+	{
+		AUECourseCharacter* Character = Cast<AUECourseCharacter>(Hit);
+
+		if (Character == nullptr || ContactFighters.Contains(Hit))
+		{
+			continue;
+		}
+
+		Character->InvokeDamage(DealDamage());
+		Stun();
+	}
+
+	ContactFighters.Reset();
+
+	for (ACharacter* Hit : Hits)
+	{
+		ContactFighters.Add(Hit);
+	}
 }
 
 int AAICharacter::DealDamage()
 {
-	return FMath::FRandRange(10, 20);
+	return IFighterInterface::DealDamage();
 }
 
 void AAICharacter::Attack()
@@ -51,6 +115,7 @@ void AAICharacter::EndAttack()
 void AAICharacter::Stun()
 {
 	IsStunned = true;
+	PublishState();
 
 	FTimerHandle TimerHandle;
 	GetWorldTimerManager().SetTimer(TimerHandle, this, &AAICharacter::EndStun, 3.f, false);
@@ -58,13 +123,76 @@ void AAICharacter::Stun()
 
 void AAICharacter::EndStun()
 {
-	IsStunned = false;
+	// A dead spider stays stunned
+	IsStunned = !IsAlive();
+	PublishState();
+}
+
+void AAICharacter::SetSignificance(ECourseSignificance NewSignificance)
+{
+	if (NewSignificance == Significance)
+	{
+		return;
+	}
+
+	Significance = NewSignificance;
+	const FCourseSignificanceSettings& Settings = UCourseSignificanceSubsystem::GetSettings(Significance);
+
+	SetActorTickInterval(Settings.TickInterval);
+	GetCharacterMovement()->SetComponentTickInterval(Settings.TickInterval);
+	GetMesh()->SetComponentTickInterval(Settings.TickInterval);
+
+	if (HPWidgetComponent != nullptr)
+	{
+		HPWidgetComponent->SetVisibility(Settings.bShowWidget);
+		HPWidgetComponent->SetComponentTickEnabled(Settings.bShowWidget);
+	}
+
+	if (HasAuthority())
+	{
+		NetUpdateFrequency = FMath::Max(DefaultNetUpdateFrequency * Settings.NetUpdateScale, MinNetUpdateFrequency);
+
+		// Only swap between the two ground modes, falling and scripted modes are left alone
+		UCharacterMovementComponent* Movement = GetCharacterMovement();
+		const EMovementMode GroundMode = Settings.bNavWalking ? MOVE_NavWalking : MOVE_Walking;
+
+		if ((Movement->MovementMode == MOVE_Walking || Movement->MovementMode == MOVE_NavWalking) && Movement->MovementMode != GroundMode)
+		{
+			Movement->SetMovementMode(GroundMode);
+		}
+	}
+}
+
+void AAICharacter::PublishState()
+{
+	ACourseAIController* Controller = Cast<ACourseAIController>(GetController());
+	UBlackboardComponent* Blackboard = Controller != nullptr ? Controller->GetBlackboardComponent() : nullptr;
+
+	if (Blackboard != nullptr)
+	{
+		Blackboard->SetValueAsBool(ACourseAIController::StunnedKey, IsStunned);
+		Blackboard->SetValueAsBool(ACourseAIController::AliveKey, IsAlive());
+	}
 }
 
 void AAICharacter::InvokeDamage(int Damage)
 {
-	CurrentHP -= Damage;
-	CurrentHP = FMath::Clamp(CurrentHP, 0, MaxHP);
+	UCourseDamageSubsystem::ApplyDamage(this, Damage);
+}
+
+int AAICharacter::TakeDamage(int Damage)
+{
+	CurrentHP = FMath::Clamp(CurrentHP - Damage, 0, MaxHP);
+	return CurrentHP;
+}
+
+void AAICharacter::OnDamageResolved(int TotalDamage, bool bKilled)
+{
+	if (bKilled)
+	{
+		IsStunned = true;
+		PublishState();
+	}
 
 	if (HPWidgetComponent != nullptr)
 	{
@@ -6,10 +6,11 @@
 #include "GameFramework/Character.h"
 #include "../FighterInterface.h"
 #include "Components/WidgetComponent.h"
+#include "CourseSignificanceSubsystem.h"
 #include "AICharacter.generated.h"
 
 UCLASS()
-class UECOURSE_API AAICharacter : public ACharacter//, public IFighterInterface
+class UECOURSE_API AAICharacter : public ACharacter, public IFighterInterface
 {
 	GENERATED_BODY()
 
@@ -19,11 +20,18 @@ public:
 	virtual void Tick(float DeltaTime) override;
 
 	UFUNCTION(BlueprintCallable, Category = Character)
-	int DealDamage();
+	virtual int DealDamage() override;
 
+	/** Queues the hit, it is applied together with the rest of the frame's hits. */
 	UFUNCTION(BlueprintCallable, Category = Character)
 	void InvokeDamage(int Damage);
 
+	// IFighterInterface
+	using ACharacter::TakeDamage;
+	virtual int TakeDamage(int Damage) override;
+	virtual bool IsAlive() const override { return CurrentHP > 0; }
+	virtual void OnDamageResolved(int TotalDamage, bool bKilled) override;
+
 	UFUNCTION(BlueprintCallable, Category = Character)
 	void Attack();
 
@@ -33,6 +41,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Character)
 	void Stun();
 
+	/** Writes the stun and alive state into the controller's blackboard. */
+	void PublishState();
+
+	/** Scales tick rates, widget visibility, net updates and movement to how relevant the spider is to players. */
+	void SetSignificance(ECourseSignificance NewSignificance);
+
+	ECourseSignificance GetSignificance() const { return Significance; }
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
 	bool IsAttacking = false;
 
@@ -50,6 +66,18 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	ECourseSignificance Significance = ECourseSignificance::High;
+
+	/** Net update frequency set on the class, significance scales down from it. */
+	float DefaultNetUpdateFrequency = 0.f;
 
 	void EndStun();
+
+	/** Server: hits the players the spider's capsule started touching, checked against their latest rewind samples. */
+	void CheckContact();
+
+	/** Players touching the capsule at the last check, so a contact hits once like a begin overlap. */
+	TArray<TWeakObjectPtr<ACharacter>, TInlineAllocator<2>> ContactFighters;
 };
@@ -0,0 +1,310 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseAIBenchmark.h"
+#include "AICharacter.h"
+#include "NavigationSystem.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+
+bool FCourseAIProfiler::bEnabled = false;
+TMap<FName, FCourseAIProfiler::FEntry> FCourseAIProfiler::Entries;
+int32 FCourseAIProfiler::NavQueries = 0;
+
+void FCourseAIProfiler::Reset()
+{
+	Entries.Reset();
+	NavQueries = 0;
+}
+
+/** Spider blueprint used when -CourseAIBenchmarkClass= is not given. */
+static const TCHAR* DefaultBenchmarkAIClass = TEXT("/Game/Course/Lesson9/BP_AICharacter.BP_AICharacter_C");
+
+/** Fixed frame time, so every run simulates the same game time. */
+static constexpr float BenchmarkDeltaTime = 1.f / 30.f;
+
+static TArray<int32> ParseAgentCounts(const FString& Value)
+{
+	TArray<FString> Parts;
+	Value.ParseIntoArray(Parts, TEXT(","));
+
+	TArray<int32> Counts;
+
+	for (const FString& Part : Parts)
+	{
+		Counts.Add(FCString::Atoi(*Part));
+	}
+
+	return Counts;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAIBenchmark(
+	TEXT("course.AI.Benchmark"),
+	TEXT("Runs the AI scalability benchmark in the current map. Usage: course.AI.Benchmark 10 100 1000"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UCourseAIBenchmarkSubsystem* Benchmark = World ? World->GetSubsystem<UCourseAIBenchmarkSubsystem>() : nullptr)
+		{
+			Benchmark->StartBenchmark(ParseAgentCounts(FString::Join(Args, TEXT(","))), false);
+		}
+	}));
+
+bool UCourseAIBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+TStatId UCourseAIBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseAIBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UCourseAIBenchmarkSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString Value;
+
+	// Separators are not stop characters, the counts are comma separated
+	if (FParse::Value(FCommandLine::Get(), TEXT("CourseAIBenchmark="), Value, false))
+	{
+		StartBenchmark(ParseAgentCounts(Value), true);
+	}
+}
+
+void UCourseAIBenchmarkSubsystem::StartBenchmark(const TArray<int32>& InAgentCounts, bool bInExitWhenDone)
+{
+	FString ClassPath = DefaultBenchmarkAIClass;
+	FParse::Value(FCommandLine::Get(), TEXT("CourseAIBenchmarkClass="), ClassPath);
+	AIClass = LoadClass<AAICharacter>(nullptr, *ClassPath);
+
+	if (AIClass == nullptr || InAgentCounts.Num() == 0 || AgentCounts.Num() > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("AI benchmark not started, check the agent counts and the AI class %s"), *ClassPath);
+		return;
+	}
+
+	AgentCounts = InAgentCounts;
+	bExitWhenDone = bInExitWhenDone;
+	CurrentRun = 0;
+	Csv = TEXT("Agents,Scope,Calls,TotalMs,MsPerFrame\n");
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(BenchmarkDeltaTime);
+
+	SpawnAgents(AgentCounts[0]);
+}
+
+void UCourseAIBenchmarkSubsystem::SpawnAgents(int32 Count)
+{
+	UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (NavSys == nullptr)
+	{
+		return;
+	}
+
+	MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+	// Same seeds for every build, so spawn points and random tree decisions match when the CSVs are compared
+	FMath::RandInit(Count);
+	FMath::SRandInit(Count);
+	FRandomStream Random(Count);
+
+	const FBox Bounds = NavSys->GetWorldBounds();
+	const FVector ProjectExtent(500.f, 500.f, Bounds.GetExtent().Z + 1000.f);
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		FNavLocation Location;
+		const FVector Point(Random.FRandRange(Bounds.Min.X, Bounds.Max.X), Random.FRandRange(Bounds.Min.Y, Bounds.Max.Y), Bounds.GetCenter().Z);
+
+		if (!NavSys->ProjectPointToNavigation(Point, Location, ProjectExtent))
+		{
+			continue;
+		}
+
+		const FRotator Rotation(0.f, Random.FRandRange(0.f, 360.f), 0.f);
+		AAICharacter* Agent = GetWorld()->SpawnActor<AAICharacter>(AIClass, Location.Location + FVector(0.f, 0.f, 100.f), Rotation, SpawnParameters);
+
+		if (Agent != nullptr)
+		{
+			Agent->SpawnDefaultController();
+			Agents.Add(Agent);
+		}
+	}
+
+	Frame = 0;
+	FCourseAIProfiler::Reset();
+}
+
+void UCourseAIBenchmarkSubsystem::DestroyAgents()
+{
+	for (const TWeakObjectPtr<AAICharacter>& Agent : Agents)
+	{
+		if (AAICharacter* Character = Agent.Get())
+		{
+			if (AController* Controller = Character->GetController())
+			{
+				Controller->Destroy();
+			}
+
+			Character->Destroy();
+		}
+	}
+
+	Agents.Reset();
+}
+
+void UCourseAIBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	Frame++;
+
+	if (Frame == WarmupFrames)
+	{
+		FCourseAIProfiler::Reset();
+		FCourseAIProfiler::bEnabled = true;
+		RunStartTime = FPlatformTime::Seconds();
+	}
+	else if (Frame == WarmupFrames + MeasuredFrames)
+	{
+		FinishRun();
+	}
+}
+
+void UCourseAIBenchmarkSubsystem::FinishRun()
+{
+	FCourseAIProfiler::bEnabled = false;
+
+	// Points that did not project to the navmesh were skipped, so the row is keyed by the agents that actually ran
+	const int32 Count = Agents.Num();
+	const double FrameMs = (FPlatformTime::Seconds() - RunStartTime) * 1000.0 / MeasuredFrames;
+	const double MemoryMB = ((double)FPlatformMemory::GetStats().UsedPhysical - (double)MemoryBefore) / (1024.0 * 1024.0);
+
+	// Sorted by name so the rows line up between builds
+	FCourseAIProfiler::Entries.KeySort(FNameLexicalLess());
+
+	for (const TPair<FName, FCourseAIProfiler::FEntry>& Pair : FCourseAIProfiler::Entries)
+	{
+		const double TotalMs = Pair.Value.Seconds * 1000.0;
+		Csv += FString::Printf(TEXT("%d,%s,%d,%.4f,%.4f\n"), Count, *Pair.Key.ToString(), Pair.Value.Calls, TotalMs, TotalMs / MeasuredFrames);
+	}
+
+	Csv += FString::Printf(TEXT("%d,NavQueries,%d,,\n"), Count, FCourseAIProfiler::NavQueries);
+	Csv += FString::Printf(TEXT("%d,Frame,%d,%.4f,%.4f\n"), Count, MeasuredFrames, FrameMs * MeasuredFrames, FrameMs);
+	Csv += FString::Printf(TEXT("%d,MemoryDeltaMB,,%.2f,\n"), Count, MemoryMB);
+
+	UE_LOG(LogTemp, Warning, TEXT("AI benchmark %d agents (%d requested): %.3f ms per frame, %d navmesh queries, %.2f MB"),
+		Count, AgentCounts[CurrentRun], FrameMs, FCourseAIProfiler::NavQueries, MemoryMB);
+
+	DestroyAgents();
+
+	if (++CurrentRun < AgentCounts.Num())
+	{
+		SpawnAgents(AgentCounts[CurrentRun]);
+	}
+	else
+	{
+		FinishBenchmark();
+	}
+}
+
+void UCourseAIBenchmarkSubsystem::FinishBenchmark()
+{
+	const FString Path = FPaths::ProfilingDir() / TEXT("AIBenchmark") / FString::Printf(TEXT("AIBenchmark-%s.csv"), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(Csv, *Path);
+	UE_LOG(LogTemp, Warning, TEXT("AI benchmark written to %s"), *Path);
+	LastCsvPath = Path;
+
+	AgentCounts.Reset();
+	FApp::SetUseFixedTimeStep(false);
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Map the automation test runs in when -CourseAIBenchmarkMap= is not given. */
+static const TCHAR* DefaultBenchmarkMap = TEXT("/Game/Levels/Level1");
+
+/** Upper bound for the whole latent run, in real seconds. */
+static constexpr double BenchmarkTestTimeout = 600.0;
+
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FCourseRunAIBenchmarkCommand, FAutomationTestBase*, Test, double, StartTime);
+
+bool FCourseRunAIBenchmarkCommand::Update()
+{
+	UWorld* World = AutomationCommon::GetAnyGameWorld();
+	UCourseAIBenchmarkSubsystem* Benchmark = World != nullptr ? World->GetSubsystem<UCourseAIBenchmarkSubsystem>() : nullptr;
+
+	if (Benchmark == nullptr)
+	{
+		Test->AddError(TEXT("No game world with the AI benchmark subsystem"));
+		return true;
+	}
+
+	// First update starts the run, the following ones wait for its CSV
+	if (StartTime == 0.0)
+	{
+		FString Counts = TEXT("10,100,1000");
+		FParse::Value(FCommandLine::Get(), TEXT("CourseAIBenchmarkTest="), Counts, false);
+
+		Benchmark->StartBenchmark(ParseAgentCounts(Counts), false);
+		StartTime = FPlatformTime::Seconds();
+
+		if (!Benchmark->IsRunning())
+		{
+			Test->AddError(TEXT("AI benchmark did not start"));
+			return true;
+		}
+
+		return false;
+	}
+
+	if (Benchmark->IsRunning())
+	{
+		if (FPlatformTime::Seconds() - StartTime > BenchmarkTestTimeout)
+		{
+			Test->AddError(FString::Printf(TEXT("AI benchmark did not finish within %.0f s"), BenchmarkTestTimeout));
+			return true;
+		}
+
+		return false;
+	}
+
+	Test->TestTrue(TEXT("AI benchmark CSV written"), FPaths::FileExists(Benchmark->GetLastCsvPath()));
+	Test->AddInfo(FString::Printf(TEXT("AI benchmark CSV: %s"), *Benchmark->GetLastCsvPath()));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCourseAIBenchmarkTest, "UECourse.AI.Benchmark",
+	EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Runs the benchmark for -CourseAIBenchmarkTest= agent counts, 10,100,1000 by default, in -CourseAIBenchmarkMap=, Level1 by default.
+ * Usage: UE4Editor UECourse -game -ExecCmds="Automation RunTests UECourse.AI.Benchmark; Quit" -unattended -nullrhi
+ */
+bool FCourseAIBenchmarkTest::RunTest(const FString& Parameters)
+{
+	FString MapName = DefaultBenchmarkMap;
+	FParse::Value(FCommandLine::Get(), TEXT("CourseAIBenchmarkMap="), MapName);
+
+	AutomationOpenMap(MapName);
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForMapToLoadCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(FCourseRunAIBenchmarkCommand(this, 0.0));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CourseAIBenchmark.generated.h"
+
+class AAICharacter;
+
+/** Game thread time and call counts of AI nodes, collected only while a benchmark runs. */
+struct UECOURSE_API FCourseAIProfiler
+{
+	struct FEntry
+	{
+		double Seconds = 0.0;
+		int32 Calls = 0;
+	};
+
+	static bool bEnabled;
+	static TMap<FName, FEntry> Entries;
+	static int32 NavQueries;
+
+	static void AddNavQueries(int32 Count = 1)
+	{
+		if (bEnabled)
+		{
+			NavQueries += Count;
+		}
+	}
+
+	static void Reset();
+};
+
+class FCourseAIProfileScope
+{
+public:
+	explicit FCourseAIProfileScope(const TCHAR* InName)
+		: Name(FCourseAIProfiler::bEnabled ? InName : nullptr)
+		, StartTime(Name != nullptr ? FPlatformTime::Seconds() : 0.0)
+	{
+	}
+
+	~FCourseAIProfileScope()
+	{
+		if (Name != nullptr)
+		{
+			FCourseAIProfiler::FEntry& Entry = FCourseAIProfiler::Entries.FindOrAdd(Name);
+			Entry.Seconds += FPlatformTime::Seconds() - StartTime;
+			Entry.Calls++;
+		}
+	}
+
+private:
+	const TCHAR* Name;
+	double StartTime;
+};
+
+#define COURSE_AI_PROFILE_SCOPE(Name) FCourseAIProfileScope PREPROCESSOR_JOIN(AIProfileScope_, __LINE__)(TEXT(Name))
+
+/**
+ * Headless AI scalability run. Started with -CourseAIBenchmark=10,100,1000 on the command line or the course.AI.Benchmark command,
+ * it spawns each number of spiders at random navmesh points of the loaded map, runs a fixed number of fixed-step frames
+ * and writes node timings, navmesh query counts and memory per agent count to a CSV in the profiling directory.
+ */
+UCLASS()
+class UECOURSE_API UCourseAIBenchmarkSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 WarmupFrames = 30;
+	static constexpr int32 MeasuredFrames = 300;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	void StartBenchmark(const TArray<int32>& InAgentCounts, bool bInExitWhenDone);
+
+	bool IsRunning() const { return AgentCounts.Num() > 0; }
+
+	/** CSV written by the last finished benchmark, empty before one finished. */
+	const FString& GetLastCsvPath() const { return LastCsvPath; }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return AgentCounts.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	TArray<int32> AgentCounts;
+	int32 CurrentRun = 0;
+	int32 Frame = 0;
+	bool bExitWhenDone = false;
+
+	UPROPERTY()
+	TSubclassOf<AAICharacter> AIClass;
+
+	TArray<TWeakObjectPtr<AAICharacter>> Agents;
+	double RunStartTime = 0.0;
+	uint64 MemoryBefore = 0;
+	FString Csv;
+	FString LastCsvPath;
+
+	void SpawnAgents(int32 Count);
+	void DestroyAgents();
+	void FinishRun();
+	void FinishBenchmark();
+};
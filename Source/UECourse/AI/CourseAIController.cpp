@@ -2,4 +2,61 @@
 
 
 #include "CourseAIController.h"
+#include "CourseAISchedulerSubsystem.h"
+#include "AICharacter.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
 
+const FName ACourseAIController::StunnedKey = TEXT("IsStunned");
+const FName ACourseAIController::AliveKey = TEXT("IsAlive");
+
+void ACourseAIController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	if (UCourseAISchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UCourseAISchedulerSubsystem>())
+	{
+		Scheduler->RegisterAgent(this);
+	}
+}
+
+void ACourseAIController::OnUnPossess()
+{
+	if (UCourseAISchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UCourseAISchedulerSubsystem>())
+	{
+		Scheduler->UnregisterAgent(this);
+	}
+
+	Super::OnUnPossess();
+}
+
+bool ACourseAIController::InitializeBlackboard(UBlackboardComponent& BlackboardComp, UBlackboardData& BlackboardAsset)
+{
+	AddStateKeys(BlackboardAsset);
+
+	if (!Super::InitializeBlackboard(BlackboardComp, BlackboardAsset))
+	{
+		return false;
+	}
+
+	if (AAICharacter* Character = Cast<AAICharacter>(GetPawn()))
+	{
+		Character->PublishState();
+	}
+
+	return true;
+}
+
+void ACourseAIController::AddStateKeys(UBlackboardData& BlackboardAsset)
+{
+	// Appended keys leave the IDs of the existing ones alone, and the tree resolves its decorator keys only after this
+	for (const FName& KeyName : { StunnedKey, AliveKey })
+	{
+		if (BlackboardAsset.GetKeyID(KeyName) == FBlackboard::InvalidKey)
+		{
+			FBlackboardEntry& Entry = BlackboardAsset.Keys.AddDefaulted_GetRef();
+			Entry.EntryName = KeyName;
+			Entry.KeyType = NewObject<UBlackboardKeyType_Bool>(&BlackboardAsset);
+		}
+	}
+}
@@ -16,7 +16,15 @@ public:
 	const FName& GetLocationKey() const { return LocationKey; }
 	const FName& GetDetectedEnemyKey() const { return DetectedEnemyKey; }
 
+	/** Bool keys the pawn's stun and alive state are published to, also the default keys of the matching decorators. */
+	static const FName StunnedKey;
+	static const FName AliveKey;
+
 protected:
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+	virtual bool InitializeBlackboard(UBlackboardComponent& BlackboardComp, UBlackboardData& BlackboardAsset) override;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	float PatrolRadius;
 
@@ -25,4 +33,8 @@ protected:
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	FName DetectedEnemyKey;
+
+private:
+	/** Adds the state keys to a blackboard asset that does not define them, before any component is sized from it. */
+	static void AddStateKeys(UBlackboardData& BlackboardAsset);
 };
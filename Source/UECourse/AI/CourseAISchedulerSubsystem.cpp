@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseAISchedulerSubsystem.h"
+#include "../UECourse.h"
+#include "CourseAIController.h"
+#include "CoursePerceptionSubsystem.h"
+#include "CourseSignificanceSubsystem.h"
+#include "AICharacter.h"
+#include "CourseAIBenchmark.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI Scheduler"), STAT_AIScheduler, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Agents Updated"), STAT_AIAgentsUpdated, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Agents Starved"), STAT_AIAgentsStarved, STATGROUP_UECourse);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("AI Avg Update Interval (ms)"), STAT_AIAvgInterval, STATGROUP_UECourse);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("AI Max Update Interval (ms)"), STAT_AIMaxInterval, STATGROUP_UECourse);
+
+static float AIBudgetMs = 2.f;
+static FAutoConsoleVariableRef CVarAIBudgetMs(
+	TEXT("course.AI.BudgetMs"),
+	AIBudgetMs,
+	TEXT("Game thread milliseconds per frame spent on AI behavior trees."));
+
+static float AIMaxInterval = 0.5f;
+static FAutoConsoleVariableRef CVarAIMaxInterval(
+	TEXT("course.AI.MaxInterval"),
+	AIMaxInterval,
+	TEXT("Seconds an AI may wait for an update before it is updated regardless of the budget."));
+
+static float AIPriorityDistance = 3000.f;
+static FAutoConsoleVariableRef CVarAIPriorityDistance(
+	TEXT("course.AI.PriorityDistance"),
+	AIPriorityDistance,
+	TEXT("AI closer than this to a player is updated with high priority."));
+
+/** How much faster a high priority agent's wait time grows. */
+static constexpr float HighPriorityWeight = 4.f;
+
+bool UCourseAISchedulerSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseAISchedulerSubsystem::Deinitialize()
+{
+	Agents.Empty();
+	DueAgents.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCourseAISchedulerSubsystem::RegisterAgent(ACourseAIController* Controller)
+{
+	if (Controller == nullptr || Agents.ContainsByPredicate([Controller](const FAgent& Agent) { return Agent.Controller == Controller; }))
+	{
+		return;
+	}
+
+	FAgent& Agent = Agents.AddDefaulted_GetRef();
+	Agent.Controller = Controller;
+	Agent.LastUpdateTime = GetWorld()->GetTimeSeconds();
+}
+
+void UCourseAISchedulerSubsystem::UnregisterAgent(ACourseAIController* Controller)
+{
+	if (Agents.RemoveAllSwap([Controller](const FAgent& Agent) { return Agent.Controller == Controller; }) > 0)
+	{
+		ReleaseBrainTick(Controller);
+	}
+}
+
+void UCourseAISchedulerSubsystem::ReleaseBrainTick(ACourseAIController* Controller)
+{
+	UBrainComponent* Brain = Controller != nullptr ? Controller->GetBrainComponent() : nullptr;
+
+	if (Brain != nullptr && Brain->IsRegistered() && !Brain->PrimaryComponentTick.IsTickFunctionRegistered())
+	{
+		Brain->PrimaryComponentTick.RegisterTickFunction(Controller->GetLevel());
+	}
+}
+
+bool UCourseAISchedulerSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->GetNetMode() != NM_Client && Agents.Num() > 0;
+}
+
+TStatId UCourseAISchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseAISchedulerSubsystem, STATGROUP_Tickables);
+}
+
+bool UCourseAISchedulerSubsystem::IsHighPriority(const ACourseAIController* Controller) const
+{
+	const APawn* Pawn = Controller->GetPawn();
+	const UCoursePerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UCoursePerceptionSubsystem>();
+
+	// The enemy search service looks within the patrol radius, so one query covers both a seen enemy and a player close by
+	const float Distance = FMath::Max(AIPriorityDistance, Controller->GetPatrolRadius());
+
+	return Pawn != nullptr && Perception != nullptr && Perception->FindNearestEnemy(Pawn->GetActorLocation(), Distance) != nullptr;
+}
+
+void UCourseAISchedulerSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AIScheduler);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	float MaxInterval = 0.f;
+
+	Agents.RemoveAllSwap([](const FAgent& Agent) { return !Agent.Controller.IsValid(); });
+	DueAgents.Reset();
+
+	for (int32 i = 0; i < Agents.Num(); i++)
+	{
+		FAgent& Agent = Agents[i];
+		const float Waited = Now - Agent.LastUpdateTime;
+		const AAICharacter* Character = Cast<AAICharacter>(Agent.Controller->GetPawn());
+		const float MinInterval = Character != nullptr ? UCourseSignificanceSubsystem::GetSettings(Character->GetSignificance()).BehaviorInterval : 0.f;
+
+		// Insignificant agents are not due yet
+		Agent.bStarved = Waited >= FMath::Max(AIMaxInterval, MinInterval);
+		Agent.Score = Agent.bHighPriority ? Waited * HighPriorityWeight : Waited;
+		MaxInterval = FMath::Max(MaxInterval, Waited);
+
+		if (Agent.bStarved || Waited >= MinInterval)
+		{
+			DueAgents.Add(i);
+		}
+	}
+
+	// Starved agents first, then the ones that waited the longest for their priority.
+	// Only the agents the budget reaches are taken off the heap, the rest are never sorted.
+	auto UpdateFirst = [this](int32 A, int32 B)
+	{
+		return Agents[A].bStarved != Agents[B].bStarved ? Agents[A].bStarved : Agents[A].Score > Agents[B].Score;
+	};
+
+	DueAgents.Heapify(UpdateFirst);
+
+	const double Deadline = FPlatformTime::Seconds() + AIBudgetMs / 1000.0;
+	int32 Updated = 0;
+	int32 Starved = 0;
+	float IntervalSum = 0.f;
+
+	while (DueAgents.Num() > 0)
+	{
+		if (!Agents[DueAgents.HeapTop()].bStarved && FPlatformTime::Seconds() >= Deadline)
+		{
+			break;
+		}
+
+		int32 Index;
+		DueAgents.HeapPop(Index, UpdateFirst, false);
+
+		FAgent& Agent = Agents[Index];
+		ACourseAIController* Controller = Agent.Controller.Get();
+		UBrainComponent* Brain = Controller->GetBrainComponent();
+		const float Interval = Now - Agent.LastUpdateTime;
+
+		if (Brain != nullptr && Brain->IsRegistered())
+		{
+			// Take the behavior tree off the regular tick, it may register again when the component is re-registered
+			if (Brain->PrimaryComponentTick.IsTickFunctionRegistered())
+			{
+				Brain->PrimaryComponentTick.UnRegisterTickFunction();
+			}
+
+			// A behavior tree that has nothing to do disables its own tick until an event wakes it up
+			if (Brain->IsComponentTickEnabled())
+			{
+				COURSE_AI_PROFILE_SCOPE("BehaviorTree");
+				Brain->TickComponent(Interval, LEVELTICK_All, nullptr);
+			}
+		}
+
+		Agent.bHighPriority = IsHighPriority(Controller);
+		Agent.LastUpdateTime = Now;
+		IntervalSum += Interval;
+		Updated++;
+		Starved += Agent.bStarved;
+	}
+
+	INC_DWORD_STAT_BY(STAT_AIAgentsUpdated, Updated);
+	INC_DWORD_STAT_BY(STAT_AIAgentsStarved, Starved);
+	SET_FLOAT_STAT(STAT_AIAvgInterval, Updated > 0 ? IntervalSum / Updated * 1000.f : 0.f);
+	SET_FLOAT_STAT(STAT_AIMaxInterval, MaxInterval * 1000.f);
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CourseAISchedulerSubsystem.generated.h"
+
+class ACourseAIController;
+
+/**
+ * Runs AI behavior trees under a per-frame time budget on the server.
+ * Registered controllers have their behavior tree tick taken over, agents that see an enemy or are near a player
+ * are updated more often, and an agent that waited longer than the starvation limit is updated regardless of the budget.
+ * An agent's priority is checked when its behavior tree is updated, so waiting agents cost no queries.
+ */
+UCLASS()
+class UECOURSE_API UCourseAISchedulerSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	void RegisterAgent(ACourseAIController* Controller);
+	void UnregisterAgent(ACourseAIController* Controller);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FAgent
+	{
+		TWeakObjectPtr<ACourseAIController> Controller;
+		float LastUpdateTime = 0.f;
+		float Score = 0.f;
+		bool bStarved = false;
+		bool bHighPriority = false;
+	};
+
+	TArray<FAgent> Agents;
+
+	/** Indices of the agents due this frame, as a heap with the next one to update on top. */
+	TArray<int32> DueAgents;
+
+	bool IsHighPriority(const ACourseAIController* Controller) const;
+
+	static void ReleaseBrainTick(ACourseAIController* Controller);
+};
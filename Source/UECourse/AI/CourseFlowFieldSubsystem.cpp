@@ -0,0 +1,485 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseFlowFieldSubsystem.h"
+#include "../UECourse.h"
+#include "CourseAIBenchmark.h"
+#include "../Core/CourseNavObstacleSubsystem.h"
+#include "NavigationSystem.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow Field Update"), STAT_FlowFieldUpdate, STATGROUP_UECourse);
+DECLARE_CYCLE_STAT(TEXT("Flow Field Integrate"), STAT_FlowFieldIntegrate, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Builds"), STAT_FlowFieldBuilds, STATGROUP_UECourse);
+
+static float FlowFieldBudgetMs = 1.f;
+static FAutoConsoleVariableRef CVarFlowFieldBudgetMs(
+	TEXT("course.AI.FlowFieldBudgetMs"),
+	FlowFieldBudgetMs,
+	TEXT("Game thread milliseconds per frame spent on sampling the navmesh and integrating flow fields."));
+
+/** Seconds a field is kept without being sampled. */
+static constexpr float FieldLifetime = 5.f;
+
+/** Neighbor offsets, straight ones first, and their step costs. */
+static const FIntPoint NeighborOffsets[8] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+static const uint16 NeighborCosts[8] = { 10, 10, 10, 10, 14, 14, 14, 14 };
+
+static FAutoConsoleCommandWithWorldAndArgs CmdFlowFieldBenchmark(
+	TEXT("course.AI.FlowFieldBenchmark"),
+	TEXT("Compares one path query per chaser with a shared flow field for N chasers around the first player. Usage: course.AI.FlowFieldBenchmark 100"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCourseFlowFieldSubsystem* FlowFields = World ? World->GetSubsystem<UCourseFlowFieldSubsystem>() : nullptr;
+		UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent<UNavigationSystemV1>(World);
+		APawn* Player = World && World->GetFirstPlayerController() ? World->GetFirstPlayerController()->GetPawn() : nullptr;
+
+		if (FlowFields == nullptr || NavSys == nullptr || Player == nullptr)
+		{
+			return;
+		}
+
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+		const float Extent = UCourseFlowFieldSubsystem::FieldSize * 100.f * 0.4f;
+		FRandomStream Random(Count);
+		TArray<FVector> Chasers;
+
+		for (int32 i = 0; i < Count; i++)
+		{
+			FNavLocation Location;
+
+			if (NavSys->GetRandomPointInNavigableRadius(Player->GetActorLocation(), Extent, Location))
+			{
+				Chasers.Add(Location.Location);
+			}
+		}
+
+		double Start = FPlatformTime::Seconds();
+		for (const FVector& Chaser : Chasers)
+		{
+			NavSys->FindPathToLocationSynchronously(World, Chaser, Player->GetActorLocation());
+		}
+		const double Paths = FPlatformTime::Seconds() - Start;
+
+		// The first request only registers the target, the field is built by the update
+		FVector Direction;
+		FlowFields->GetFlowDirection(Player, Player->GetActorLocation(), Direction);
+
+		Start = FPlatformTime::Seconds();
+		FlowFields->UpdateFields(TNumericLimits<float>::Max());
+		const double Build = FPlatformTime::Seconds() - Start;
+
+		int32 Sampled = 0;
+		Start = FPlatformTime::Seconds();
+		for (const FVector& Chaser : Chasers)
+		{
+			Sampled += FlowFields->GetFlowDirection(Player, Chaser, Direction);
+		}
+		const double Samples = FPlatformTime::Seconds() - Start;
+
+		UE_LOG(LogTemp, Warning, TEXT("Flow field benchmark %d chasers: path queries %.3f ms, field build %.3f ms (includes navmesh sampling on first run), samples %.3f ms (%d in field)"),
+			Chasers.Num(), Paths * 1000.0, Build * 1000.0, Samples * 1000.0, Sampled);
+	}));
+
+bool UCourseFlowFieldSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseFlowFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// The navmesh only changes at runtime under the obstacles' nav modifiers
+	if (UCourseNavObstacleSubsystem* NavObstacles = InWorld.GetSubsystem<UCourseNavObstacleSubsystem>())
+	{
+		NavObstacles->OnObstaclesBuilt.AddUObject(this, &UCourseFlowFieldSubsystem::HandleObstaclesBuilt);
+	}
+}
+
+void UCourseFlowFieldSubsystem::HandleObstaclesBuilt(const TArray<FBox>& DirtyBounds)
+{
+	const float ChunkExtent = ChunkSize * CellSize;
+
+	for (const FBox& Bounds : DirtyBounds)
+	{
+		// A cell is sampled half a cell around its center, and the navmesh is eroded around the obstacle
+		const FBox Dirty = Bounds.ExpandBy(CellSize);
+		const FIntPoint MinChunk(FMath::FloorToInt(Dirty.Min.X / ChunkExtent), FMath::FloorToInt(Dirty.Min.Y / ChunkExtent));
+		const FIntPoint MaxChunk(FMath::FloorToInt(Dirty.Max.X / ChunkExtent), FMath::FloorToInt(Dirty.Max.Y / ChunkExtent));
+
+		for (int32 ChunkY = MinChunk.Y; ChunkY <= MaxChunk.Y; ChunkY++)
+		{
+			for (int32 ChunkX = MinChunk.X; ChunkX <= MaxChunk.X; ChunkX++)
+			{
+				Chunks.Remove(FIntPoint(ChunkX, ChunkY));
+			}
+		}
+
+		const FIntPoint MinCell = GetCell(Dirty.Min);
+		const FIntPoint MaxCell = GetCell(Dirty.Max);
+
+		auto Overlaps = [&MinCell, &MaxCell](const FIntPoint& Origin)
+		{
+			return MaxCell.X >= Origin.X && MaxCell.Y >= Origin.Y && MinCell.X < Origin.X + FieldSize && MinCell.Y < Origin.Y + FieldSize;
+		};
+
+		// Fields over the area are integrated again, and keep answering from their old costs until then
+		for (TPair<TWeakObjectPtr<AActor>, FField>& Pair : Fields)
+		{
+			FField& Field = Pair.Value;
+
+			if (Field.bBuilt && Overlaps(Field.Origin))
+			{
+				Field.bDirty = true;
+			}
+
+			// A build in progress integrates over a copy of the old walkability
+			if (Field.bBuilding && Overlaps(Field.Build.Origin))
+			{
+				Field.bBuilding = false;
+				Field.bDirty = true;
+			}
+		}
+	}
+}
+
+TStatId UCourseFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+FIntPoint UCourseFlowFieldSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+FIntPoint UCourseFlowFieldSubsystem::GetChunk(const FIntPoint& Cell)
+{
+	return FIntPoint(FMath::FloorToInt((float)Cell.X / ChunkSize), FMath::FloorToInt((float)Cell.Y / ChunkSize));
+}
+
+bool UCourseFlowFieldSubsystem::GetFlowDirection(AActor* Target, const FVector& Location, FVector& OutDirection)
+{
+	if (Target == nullptr)
+	{
+		return false;
+	}
+
+	FField& Field = Fields.FindOrAdd(Target);
+	Field.LastUsedTime = GetWorld()->GetTimeSeconds();
+
+	if (!Field.bBuilt)
+	{
+		return false;
+	}
+
+	const FIntPoint Cell = GetCell(Location) - Field.Origin;
+
+	if (Cell.X < 0 || Cell.Y < 0 || Cell.X >= FieldSize || Cell.Y >= FieldSize)
+	{
+		return false;
+	}
+
+	const int32 Index = Cell.Y * FieldSize + Cell.X;
+
+	if (Field.Costs[Index] == Unreachable)
+	{
+		return false;
+	}
+
+	// In the target's cell, or in a cell without a better neighbor, head straight for the target
+	if (Field.Directions[Index] < 0)
+	{
+		OutDirection = (Target->GetActorLocation() - Location).GetSafeNormal2D();
+		return true;
+	}
+
+	const FIntPoint& Offset = NeighborOffsets[Field.Directions[Index]];
+	OutDirection = FVector(Offset.X, Offset.Y, 0.f).GetSafeNormal();
+	return true;
+}
+
+void UCourseFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	UpdateFields(FlowFieldBudgetMs / 1000.0);
+}
+
+void UCourseFlowFieldSubsystem::UpdateFields(double BudgetSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldUpdate);
+
+	const double Deadline = FPlatformTime::Seconds() + BudgetSeconds;
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	for (auto It = Fields.CreateIterator(); It; ++It)
+	{
+		AActor* Target = It.Key().Get();
+		FField& Field = It.Value();
+
+		if (Target == nullptr || Now - Field.LastUsedTime > FieldLifetime)
+		{
+			It.RemoveCurrent();
+			bEvictChunks = true;
+			continue;
+		}
+
+		if (!Field.bBuilding)
+		{
+			const FIntPoint TargetCell = GetCell(Target->GetActorLocation());
+
+			// Nothing to do while the target stays in its cell
+			if (Field.bBuilt && !Field.bDirty && TargetCell == Field.TargetCell)
+			{
+				continue;
+			}
+
+			// Recenter the window only when the target gets close to its edge, so its chunks stay the same most of the time
+			const FIntPoint Local = TargetCell - Field.Origin;
+			FIntPoint Origin = Field.Origin;
+
+			if (!Field.bBuilt || Local.X < FieldSize / 4 || Local.Y < FieldSize / 4 || Local.X >= FieldSize * 3 / 4 || Local.Y >= FieldSize * 3 / 4)
+			{
+				Origin = TargetCell - FIntPoint(FieldSize / 2, FieldSize / 2);
+				bEvictChunks = true;
+			}
+
+			// A target moving on while this builds is picked up by the next build
+			Field.Build.Origin = Origin;
+			Field.Build.TargetCell = TargetCell;
+			Field.Build.bSampled = false;
+			Field.bBuilding = true;
+			Field.bDirty = false;
+		}
+
+		if (FPlatformTime::Seconds() >= Deadline)
+		{
+			break;
+		}
+
+		FFieldBuild& Build = Field.Build;
+
+		// The old field keeps answering with its own window until the new one is built
+		if (!Build.bSampled)
+		{
+			if (!SampleChunks(Build.Origin, Target->GetActorLocation().Z, Deadline))
+			{
+				continue;
+			}
+
+			StartBuild(Build);
+		}
+
+		if (!IntegrateBuild(Build, Deadline))
+		{
+			continue;
+		}
+
+		Field.Origin = Build.Origin;
+		Field.TargetCell = Build.TargetCell;
+		Swap(Field.Costs, Build.Costs);
+		Swap(Field.Directions, Build.Directions);
+		Field.bBuilt = true;
+		Field.bBuilding = false;
+		INC_DWORD_STAT(STAT_FlowFieldBuilds);
+	}
+
+	if (bEvictChunks)
+	{
+		EvictChunks();
+	}
+}
+
+void UCourseFlowFieldSubsystem::EvictChunks()
+{
+	bEvictChunks = false;
+
+	TSet<FIntPoint> Covered;
+
+	auto Cover = [&Covered](const FIntPoint& Origin)
+	{
+		const FIntPoint MinChunk = GetChunk(Origin);
+		const FIntPoint MaxChunk = GetChunk(Origin + FIntPoint(FieldSize - 1, FieldSize - 1));
+
+		for (int32 ChunkY = MinChunk.Y; ChunkY <= MaxChunk.Y; ChunkY++)
+		{
+			for (int32 ChunkX = MinChunk.X; ChunkX <= MaxChunk.X; ChunkX++)
+			{
+				Covered.Add(FIntPoint(ChunkX, ChunkY));
+			}
+		}
+	};
+
+	for (const TPair<TWeakObjectPtr<AActor>, FField>& Pair : Fields)
+	{
+		if (Pair.Value.bBuilt)
+		{
+			Cover(Pair.Value.Origin);
+		}
+
+		if (Pair.Value.bBuilding)
+		{
+			Cover(Pair.Value.Build.Origin);
+		}
+	}
+
+	for (auto It = Chunks.CreateIterator(); It; ++It)
+	{
+		if (!Covered.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool UCourseFlowFieldSubsystem::SampleChunks(const FIntPoint& Origin, float Z, double Deadline)
+{
+	UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (NavSys == nullptr)
+	{
+		return false;
+	}
+
+	const FIntPoint MinChunk(FMath::FloorToInt((float)Origin.X / ChunkSize), FMath::FloorToInt((float)Origin.Y / ChunkSize));
+	const FIntPoint MaxChunk(FMath::FloorToInt((float)(Origin.X + FieldSize - 1) / ChunkSize), FMath::FloorToInt((float)(Origin.Y + FieldSize - 1) / ChunkSize));
+	const FVector Extent(CellSize * 0.5f, CellSize * 0.5f, 500.f);
+	bool bComplete = true;
+
+	for (int32 ChunkY = MinChunk.Y; ChunkY <= MaxChunk.Y; ChunkY++)
+	{
+		for (int32 ChunkX = MinChunk.X; ChunkX <= MaxChunk.X; ChunkX++)
+		{
+			FChunk* Chunk = Chunks.Find(FIntPoint(ChunkX, ChunkY));
+
+			if (Chunk == nullptr)
+			{
+				Chunk = &Chunks.Add(FIntPoint(ChunkX, ChunkY));
+				Chunk->Walkable.Init(false, ChunkSize * ChunkSize);
+				Chunk->Z = Z;
+			}
+
+			// Sampling resumes where the previous frame's budget ran out
+			while (!Chunk->IsComplete() && FPlatformTime::Seconds() < Deadline)
+			{
+				const int32 LocalX = Chunk->NumSampled % ChunkSize;
+				const int32 LocalY = Chunk->NumSampled / ChunkSize;
+				const FVector Center((ChunkX * ChunkSize + LocalX + 0.5f) * CellSize, (ChunkY * ChunkSize + LocalY + 0.5f) * CellSize, Chunk->Z);
+
+				FNavLocation NavLocation;
+				Chunk->Walkable[Chunk->NumSampled] = NavSys->ProjectPointToNavigation(Center, NavLocation, Extent);
+				Chunk->NumSampled++;
+				FCourseAIProfiler::AddNavQueries();
+			}
+
+			bComplete &= Chunk->IsComplete();
+		}
+	}
+
+	return bComplete;
+}
+
+void UCourseFlowFieldSubsystem::StartBuild(FFieldBuild& Build) const
+{
+	const int32 NumCells = FieldSize * FieldSize;
+
+	// Copied once, so integration reads a bit per neighbor instead of looking up its chunk
+	Build.Walkable.Init(false, NumCells);
+
+	for (int32 Y = 0; Y < FieldSize; Y++)
+	{
+		FIntPoint ChunkKey(MAX_int32, MAX_int32);
+		const FChunk* Chunk = nullptr;
+
+		for (int32 X = 0; X < FieldSize; X++)
+		{
+			const FIntPoint Cell = Build.Origin + FIntPoint(X, Y);
+			const FIntPoint CellChunk = GetChunk(Cell);
+
+			if (CellChunk != ChunkKey)
+			{
+				ChunkKey = CellChunk;
+				Chunk = Chunks.Find(ChunkKey);
+			}
+
+			if (Chunk != nullptr && Chunk->IsComplete())
+			{
+				Build.Walkable[Y * FieldSize + X] = Chunk->Walkable[(Cell.Y - ChunkKey.Y * ChunkSize) * ChunkSize + Cell.X - ChunkKey.X * ChunkSize];
+			}
+		}
+	}
+
+	Build.Costs.Init(Unreachable, NumCells);
+	Build.Directions.Init(INDEX_NONE, NumCells);
+
+	const FIntPoint Target = Build.TargetCell - Build.Origin;
+	const int32 TargetIndex = Target.Y * FieldSize + Target.X;
+	Build.Costs[TargetIndex] = 0;
+
+	Build.Open.Reset();
+	Build.Open.Add(FOpenCell(0, TargetIndex));
+	Build.bSampled = true;
+}
+
+bool UCourseFlowFieldSubsystem::IntegrateBuild(FFieldBuild& Build, double Deadline) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldIntegrate);
+
+	// Dijkstra from the target over walkable cells, the target cell itself always counts as walkable
+	auto CheaperFirst = [](const FOpenCell& A, const FOpenCell& B) { return A.Key < B.Key; };
+	int32 Steps = 0;
+
+	while (Build.Open.Num() > 0)
+	{
+		// The clock is read every few hundred cells, it costs more than a cell
+		if ((++Steps & 255) == 0 && FPlatformTime::Seconds() >= Deadline)
+		{
+			return false;
+		}
+
+		FOpenCell Current;
+		Build.Open.HeapPop(Current, CheaperFirst, false);
+
+		if (Current.Key > Build.Costs[Current.Value])
+		{
+			continue;
+		}
+
+		const FIntPoint Cell(Current.Value % FieldSize, Current.Value / FieldSize);
+
+		for (int32 i = 0; i < 8; i++)
+		{
+			const FIntPoint Next = Cell + NeighborOffsets[i];
+
+			if (Next.X < 0 || Next.Y < 0 || Next.X >= FieldSize || Next.Y >= FieldSize)
+			{
+				continue;
+			}
+
+			const int32 NextIndex = Next.Y * FieldSize + Next.X;
+
+			if (!Build.Walkable[NextIndex])
+			{
+				continue;
+			}
+
+			// No cutting corners past blocked cells
+			if (i >= 4 && (!Build.Walkable[Cell.Y * FieldSize + Next.X] || !Build.Walkable[Next.Y * FieldSize + Cell.X]))
+			{
+				continue;
+			}
+
+			const int32 Cost = Current.Key + NeighborCosts[i];
+
+			if (Cost < Build.Costs[NextIndex])
+			{
+				Build.Costs[NextIndex] = (uint16)Cost;
+				Build.Directions[NextIndex] = (int8)(i < 4 ? i ^ 1 : 11 - i);
+				Build.Open.HeapPush(FOpenCell(Cost, NextIndex), CheaperFirst);
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CourseFlowFieldSubsystem.generated.h"
+
+/**
+ * Flow fields toward chased actors, shared by every AI chasing the same target.
+ * Walkable cells are sampled from the navmesh once per chunk and cached, a field is integrated again only when its
+ * target moves to another cell. Chunks under obstacles cut into the navmesh at runtime are sampled again, and chunks no
+ * field covers any more are dropped. Integration is spread over frames under the budget, the previous field answers
+ * until the new one is done. Chasers read their move direction from the field without a path query.
+ */
+UCLASS()
+class UECOURSE_API UCourseFlowFieldSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Cells per side of a field window. */
+	static constexpr int32 FieldSize = 96;
+
+	/** Cells per side of a cached walkability chunk. */
+	static constexpr int32 ChunkSize = 32;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/**
+	 * Direction to move from Location toward Target. Starts maintaining a field for Target on first use,
+	 * returns false until it is built or when Location is outside of it or cut off from the target.
+	 */
+	bool GetFlowDirection(AActor* Target, const FVector& Location, FVector& OutDirection);
+
+	/** Samples walkability and builds fields until the budget is spent. */
+	void UpdateFields(double BudgetSeconds);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Fields.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	static constexpr uint16 Unreachable = MAX_uint16;
+
+	typedef TPair<int32, int32> FOpenCell;
+
+	/** Field being integrated, over a copy of its window's walkability. */
+	struct FFieldBuild
+	{
+		FIntPoint Origin = FIntPoint::ZeroValue;
+		FIntPoint TargetCell = FIntPoint::ZeroValue;
+		TBitArray<> Walkable;
+		TArray<uint16> Costs;
+		TArray<int8> Directions;
+		TArray<FOpenCell> Open;
+		bool bSampled = false;
+	};
+
+	struct FField
+	{
+		FIntPoint Origin = FIntPoint::ZeroValue;
+		FIntPoint TargetCell = FIntPoint(MAX_int32, MAX_int32);
+		TArray<uint16> Costs;
+		TArray<int8> Directions;
+		float LastUsedTime = 0.f;
+		bool bBuilt = false;
+
+		/** Obstacles changed the navmesh under the window since it was sampled. */
+		bool bDirty = false;
+
+		bool bBuilding = false;
+		FFieldBuild Build;
+	};
+
+	struct FChunk
+	{
+		TBitArray<> Walkable;
+		int32 NumSampled = 0;
+		float Z = 0.f;
+
+		bool IsComplete() const { return NumSampled == ChunkSize * ChunkSize; }
+	};
+
+	TMap<TWeakObjectPtr<AActor>, FField> Fields;
+	TMap<FIntPoint, FChunk> Chunks;
+	float CellSize = 100.f;
+
+	/** A window moved or a field went away, so some chunks may no longer be covered. */
+	bool bEvictChunks = false;
+
+	FIntPoint GetCell(const FVector& Location) const;
+	static FIntPoint GetChunk(const FIntPoint& Cell);
+	bool SampleChunks(const FIntPoint& Origin, float Z, double Deadline);
+	void StartBuild(FFieldBuild& Build) const;
+
+	/** Integrates until the deadline, returns true once every reachable cell has its cost. */
+	bool IntegrateBuild(FFieldBuild& Build, double Deadline) const;
+
+	void EvictChunks();
+
+	void HandleObstaclesBuilt(const TArray<FBox>& DirtyBounds);
+};
@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoursePatrolPointSubsystem.h"
+#include "../UECourse.h"
+#include "CourseAIBenchmark.h"
+#include "NavigationSystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Patrol Point Queries"), STAT_PatrolPointQueries, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Patrol Point Cache Hits"), STAT_PatrolPointHits, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Patrol Point Navmesh Queries"), STAT_PatrolPointMisses, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Patrol Point Queue"), STAT_PatrolPointQueue, STATGROUP_UECourse);
+
+static float PatrolPointBudgetMs = 0.5f;
+static FAutoConsoleVariableRef CVarPatrolPointBudgetMs(
+	TEXT("course.AI.PatrolPointBudgetMs"),
+	PatrolPointBudgetMs,
+	TEXT("Game thread milliseconds per frame spent on queued patrol point navmesh queries."));
+
+/** Size of a cache region in unreal units. */
+static constexpr float PatrolCellSize = 2000.f;
+
+/** Points kept per region, new navmesh results replace random old ones after that. */
+static constexpr int32 PointsPerCell = 16;
+
+/** Cached points a request needs in range before it is answered from the cache. */
+static constexpr int32 MinCandidates = 4;
+
+static FAutoConsoleCommandWithWorldAndArgs CmdPatrolPointBenchmark(
+	TEXT("course.AI.PatrolPointBenchmark"),
+	TEXT("Compares synchronous navmesh patrol queries with the patrol point cache for N agents around the first player. Usage: course.AI.PatrolPointBenchmark 500"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCoursePatrolPointSubsystem* PatrolPoints = World ? World->GetSubsystem<UCoursePatrolPointSubsystem>() : nullptr;
+		UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent<UNavigationSystemV1>(World);
+		APawn* Player = World ? World->GetFirstPlayerController() ? World->GetFirstPlayerController()->GetPawn() : nullptr : nullptr;
+
+		if (PatrolPoints == nullptr || NavSys == nullptr || Player == nullptr)
+		{
+			return;
+		}
+
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 500;
+		const float Radius = 1500.f;
+		FRandomStream Stream(Count);
+		TArray<FVector> Agents;
+
+		for (int32 i = 0; i < Count; i++)
+		{
+			Agents.Add(Player->GetActorLocation() + FVector(Stream.FRandRange(-5000.f, 5000.f), Stream.FRandRange(-5000.f, 5000.f), 0.f));
+		}
+
+		FNavLocation Result;
+		double Start = FPlatformTime::Seconds();
+		for (const FVector& Agent : Agents)
+		{
+			NavSys->GetRandomReachablePointInRadius(Agent, Radius, Result);
+		}
+		const double Sync = FPlatformTime::Seconds() - Start;
+
+		// Warm up the cache the way a running game would, then measure requests answered from it
+		for (const FVector& Agent : Agents)
+		{
+			PatrolPoints->RequestPoint(Agent, Radius, FCourseOnPatrolPoint());
+		}
+		PatrolPoints->ProcessRequests(TNumericLimits<float>::Max());
+
+		int32 Hits = 0;
+		FVector Location;
+		Start = FPlatformTime::Seconds();
+		for (const FVector& Agent : Agents)
+		{
+			Hits += PatrolPoints->TryGetCachedPoint(Agent, Radius, Location);
+		}
+		const double Cached = FPlatformTime::Seconds() - Start;
+
+		UE_LOG(LogTemp, Warning, TEXT("Patrol point benchmark %d agents: navmesh %.3f ms cache %.3f ms (%d hits), %.3f ms saved"),
+			Count, Sync * 1000.0, Cached * 1000.0, Hits, (Sync - Cached) * 1000.0);
+	}));
+
+bool UCoursePatrolPointSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCoursePatrolPointSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	Random.GenerateNewSeed();
+
+	if (UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &UCoursePatrolPointSubsystem::HandleNavigationGenerationFinished);
+	}
+}
+
+void UCoursePatrolPointSubsystem::HandleNavigationGenerationFinished(ANavigationData* NavData)
+{
+	// Cached points may be off the rebuilt navmesh
+	ClearCache();
+}
+
+void UCoursePatrolPointSubsystem::ClearCache()
+{
+	CachedPoints.Reset();
+}
+
+FIntPoint UCoursePatrolPointSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / PatrolCellSize), FMath::FloorToInt(Location.Y / PatrolCellSize));
+}
+
+void UCoursePatrolPointSubsystem::CachePoint(const FVector& Location)
+{
+	TArray<FVector>& Points = CachedPoints.FindOrAdd(GetCell(Location));
+
+	if (Points.Num() < PointsPerCell)
+	{
+		Points.Add(Location);
+	}
+	else
+	{
+		Points[Random.RandHelper(PointsPerCell)] = Location;
+	}
+}
+
+bool UCoursePatrolPointSubsystem::TryGetCachedPoint(const FVector& Origin, float Radius, FVector& OutLocation)
+{
+	const FIntPoint Min = GetCell(Origin - FVector(Radius));
+	const FIntPoint Max = GetCell(Origin + FVector(Radius));
+	const float RadiusSq = FMath::Square(Radius);
+
+	TArray<FVector, TInlineAllocator<64>> Candidates;
+
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			if (const TArray<FVector>* Points = CachedPoints.Find(FIntPoint(X, Y)))
+			{
+				for (const FVector& Point : *Points)
+				{
+					if (FVector::DistSquared2D(Origin, Point) <= RadiusSq)
+					{
+						Candidates.Add(Point);
+					}
+				}
+			}
+		}
+	}
+
+	// Too few points would send every agent of the area to the same spots
+	if (Candidates.Num() < MinCandidates)
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_PatrolPointHits);
+	OutLocation = Candidates[Random.RandHelper(Candidates.Num())];
+	return true;
+}
+
+int32 UCoursePatrolPointSubsystem::RequestPoint(const FVector& Origin, float Radius, FCourseOnPatrolPoint Callback)
+{
+	FRequest& Request = Requests.AddDefaulted_GetRef();
+	Request.Id = NextRequestId++;
+	Request.Origin = Origin;
+	Request.Radius = Radius;
+	Request.Callback = MoveTemp(Callback);
+
+	INC_DWORD_STAT(STAT_PatrolPointQueue);
+	return Request.Id;
+}
+
+void UCoursePatrolPointSubsystem::CancelRequest(int32 RequestId)
+{
+	const int32 Removed = Requests.RemoveAll([RequestId](const FRequest& Request) { return Request.Id == RequestId; });
+	DEC_DWORD_STAT_BY(STAT_PatrolPointQueue, Removed);
+}
+
+bool UCoursePatrolPointSubsystem::IsTickable() const
+{
+	return Requests.Num() > 0;
+}
+
+TStatId UCoursePatrolPointSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCoursePatrolPointSubsystem, STATGROUP_Tickables);
+}
+
+void UCoursePatrolPointSubsystem::Tick(float DeltaTime)
+{
+	ProcessRequests(PatrolPointBudgetMs / 1000.0);
+}
+
+void UCoursePatrolPointSubsystem::ProcessRequests(double BudgetSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PatrolPointQueries);
+
+	UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const double Deadline = FPlatformTime::Seconds() + BudgetSeconds;
+
+	// Requests are answered in order, a query that warms a region also serves the requests queued behind it
+	while (Requests.Num() > 0 && FPlatformTime::Seconds() < Deadline)
+	{
+		// Callbacks may queue or cancel requests, so take the request out of the queue first
+		FRequest Request = MoveTemp(Requests[0]);
+		Requests.RemoveAt(0, 1, false);
+		DEC_DWORD_STAT(STAT_PatrolPointQueue);
+
+		FVector Location;
+		bool bSuccess = TryGetCachedPoint(Request.Origin, Request.Radius, Location);
+
+		if (!bSuccess && NavSys != nullptr)
+		{
+			INC_DWORD_STAT(STAT_PatrolPointMisses);
+			FCourseAIProfiler::AddNavQueries();
+
+			FNavLocation Result;
+			bSuccess = NavSys->GetRandomReachablePointInRadius(Request.Origin, Request.Radius, Result);
+
+			if (bSuccess)
+			{
+				Location = Result.Location;
+				CachePoint(Location);
+			}
+		}
+
+		Request.Callback.ExecuteIfBound(bSuccess, Location);
+	}
+}
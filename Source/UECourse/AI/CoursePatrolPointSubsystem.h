@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CoursePatrolPointSubsystem.generated.h"
+
+DECLARE_DELEGATE_TwoParams(FCourseOnPatrolPoint, bool /*bSuccess*/, const FVector& /*Location*/);
+
+/**
+ * Answers random patrol point requests from a cache of navigable points per region.
+ * Requests the cache cannot answer are queued and resolved against the navmesh under a per-frame time budget,
+ * every navmesh result is added to the cache of its region.
+ */
+UCLASS()
+class UECOURSE_API UCoursePatrolPointSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Random cached point within Radius of Origin, without touching the navmesh. */
+	bool TryGetCachedPoint(const FVector& Origin, float Radius, FVector& OutLocation);
+
+	/** Queues a navmesh query, Callback is called from a later tick. Returns an id for CancelRequest. */
+	int32 RequestPoint(const FVector& Origin, float Radius, FCourseOnPatrolPoint Callback);
+
+	void CancelRequest(int32 RequestId);
+
+	/** Resolves queued requests until the budget is spent. */
+	void ProcessRequests(double BudgetSeconds);
+
+	void ClearCache();
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FRequest
+	{
+		int32 Id = 0;
+		FVector Origin = FVector::ZeroVector;
+		float Radius = 0.f;
+		FCourseOnPatrolPoint Callback;
+	};
+
+	TArray<FRequest> Requests;
+	TMap<FIntPoint, TArray<FVector>> CachedPoints;
+	FRandomStream Random;
+	int32 NextRequestId = 1;
+
+	FIntPoint GetCell(const FVector& Location) const;
+	void CachePoint(const FVector& Location);
+
+	UFUNCTION()
+	void HandleNavigationGenerationFinished(class ANavigationData* NavData);
+};
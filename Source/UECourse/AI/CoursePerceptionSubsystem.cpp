@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoursePerceptionSubsystem.h"
+#include "../UECourse.h"
+#include "../UECourseCharacter.h"
+#include "../Core/CourseActorRegistrySubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "Kismet/KismetSystemLibrary.h"
+
+DECLARE_CYCLE_STAT(TEXT("Perception Grid Refresh"), STAT_PerceptionRefresh, STATGROUP_UECourse);
+DECLARE_CYCLE_STAT(TEXT("Perception Query"), STAT_PerceptionQuery, STATGROUP_UECourse);
+
+static float PerceptionCellSize = 1000.f;
+static FAutoConsoleVariableRef CVarPerceptionCellSize(
+	TEXT("course.Perception.CellSize"),
+	PerceptionCellSize,
+	TEXT("Size of a perception grid cell in unreal units, should be close to the typical AI patrol radius."));
+
+static FAutoConsoleCommandWithWorldAndArgs CmdPerceptionBenchmark(
+	TEXT("course.Perception.Benchmark"),
+	TEXT("Compares grid perception queries with the old per-AI sphere trace at N agents. Usage: course.Perception.Benchmark 50 500 2000"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCoursePerceptionSubsystem* Perception = World ? World->GetSubsystem<UCoursePerceptionSubsystem>() : nullptr;
+
+		if (Perception == nullptr)
+		{
+			return;
+		}
+
+		TArray<int32> Counts;
+
+		for (const FString& Arg : Args)
+		{
+			Counts.Add(FCString::Atoi(*Arg));
+		}
+
+		if (Counts.Num() == 0)
+		{
+			Counts = { 50, 500, 2000 };
+		}
+
+		const float Radius = 1000.f;
+		const float Extent = 20000.f;
+		const int32 Iterations = 10;
+
+		TArray<TEnumAsByte<EObjectTypeQuery>> TraceObjectTypes;
+		TraceObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECollisionChannel::ECC_Pawn));
+
+		Perception->RefreshGrid();
+
+		for (int32 Count : Counts)
+		{
+			FRandomStream Random(Count);
+			TArray<FVector> Agents;
+
+			for (int32 i = 0; i < Count; i++)
+			{
+				Agents.Add(FVector(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), 100.f));
+			}
+
+			int32 Found = 0;
+			double Start = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Iterations; i++)
+			{
+				for (const FVector& Agent : Agents)
+				{
+					Found += Perception->FindNearestEnemy(Agent, Radius) != nullptr;
+				}
+			}
+			const double Grid = (FPlatformTime::Seconds() - Start) / Iterations;
+
+			TArray<FHitResult> OutHits;
+			Start = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Iterations; i++)
+			{
+				for (const FVector& Agent : Agents)
+				{
+					UKismetSystemLibrary::SphereTraceMultiForObjects(World, Agent, Agent, Radius, TraceObjectTypes, false, TArray<AActor*>(), EDrawDebugTrace::None, OutHits, true);
+				}
+			}
+			const double Trace = (FPlatformTime::Seconds() - Start) / Iterations;
+
+			UE_LOG(LogTemp, Warning, TEXT("Perception benchmark %d agents: grid %.3f ms trace %.3f ms per frame, %d hits"),
+				Count, Grid * 1000.0, Trace * 1000.0, Found / Iterations);
+		}
+	}));
+
+bool UCoursePerceptionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+bool UCoursePerceptionSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->GetNetMode() != NM_Client;
+}
+
+TStatId UCoursePerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCoursePerceptionSubsystem, STATGROUP_Tickables);
+}
+
+void UCoursePerceptionSubsystem::Tick(float DeltaTime)
+{
+	RefreshGrid();
+}
+
+FIntPoint UCoursePerceptionSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UCoursePerceptionSubsystem::RefreshGrid()
+{
+	SCOPE_CYCLE_COUNTER(STAT_PerceptionRefresh);
+
+	Targets.Reset();
+	Cells.Reset();
+	MaxTargetRadius = 0.f;
+	CellSize = FMath::Max(PerceptionCellSize, 100.f);
+
+	UCourseActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UCourseActorRegistrySubsystem>();
+
+	if (Registry == nullptr)
+	{
+		return;
+	}
+
+	TArray<AUECourseCharacter*> Players;
+	Registry->GetActorsOfClass<AUECourseCharacter>(Players);
+
+	for (AUECourseCharacter* Player : Players)
+	{
+		FTarget& Target = Targets.AddDefaulted_GetRef();
+		Target.Actor = Player;
+		Target.Location = Player->GetActorLocation();
+		Target.Radius = Player->GetCapsuleComponent()->GetScaledCapsuleRadius();
+		MaxTargetRadius = FMath::Max(MaxTargetRadius, Target.Radius);
+
+		Cells.FindOrAdd(GetCell(Target.Location)).Add(Targets.Num() - 1);
+	}
+}
+
+AActor* UCoursePerceptionSubsystem::FindNearestEnemy(const FVector& Location, float Radius) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PerceptionQuery);
+
+	if (Targets.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	const float Reach = Radius + MaxTargetRadius;
+	const FIntPoint Min = GetCell(Location - FVector(Reach));
+	const FIntPoint Max = GetCell(Location + FVector(Reach));
+
+	AActor* Nearest = nullptr;
+	float NearestDistSq = TNumericLimits<float>::Max();
+
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			const TArray<int32, TInlineAllocator<4>>* Cell = Cells.Find(FIntPoint(X, Y));
+
+			if (Cell == nullptr)
+			{
+				continue;
+			}
+
+			for (int32 Index : *Cell)
+			{
+				const FTarget& Target = Targets[Index];
+				const float DistSq = FVector::DistSquared(Location, Target.Location);
+
+				if (DistSq <= FMath::Square(Radius + Target.Radius) && DistSq < NearestDistSq)
+				{
+					if (AActor* Actor = Target.Actor.Get())
+					{
+						Nearest = Actor;
+						NearestDistSq = DistSq;
+					}
+				}
+			}
+		}
+	}
+
+	return Nearest;
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CoursePerceptionSubsystem.generated.h"
+
+/**
+ * Player positions bucketed into a uniform 2D grid, rebuilt once per frame on the server.
+ * AI perception queries read the grid instead of running physics traces.
+ */
+UCLASS()
+class UECOURSE_API UCoursePerceptionSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Closest player whose capsule is within Radius of Location, or nullptr. */
+	AActor* FindNearestEnemy(const FVector& Location, float Radius) const;
+
+	/** Rebuilds the grid from the current player positions. */
+	void RefreshGrid();
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FTarget
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FVector Location = FVector::ZeroVector;
+		float Radius = 0.f;
+	};
+
+	TArray<FTarget> Targets;
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+	float CellSize = 1000.f;
+	float MaxTargetRadius = 0.f;
+
+	FIntPoint GetCell(const FVector& Location) const;
+};
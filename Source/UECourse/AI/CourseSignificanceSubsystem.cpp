@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseSignificanceSubsystem.h"
+#include "../UECourse.h"
+#include "AICharacter.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI Significance"), STAT_AISignificance, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI High Significance"), STAT_AIHighSignificance, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Dormant"), STAT_AIDormant, STATGROUP_UECourse);
+
+static int32 AISignificanceEnabled = 1;
+static FAutoConsoleVariableRef CVarAISignificanceEnabled(
+	TEXT("course.AI.Significance"),
+	AISignificanceEnabled,
+	TEXT("Scale AI update rates by distance and visibility to players. 0 runs every AI at full rate."));
+
+static float AISignificanceDistance = 6000.f;
+static FAutoConsoleVariableRef CVarAISignificanceDistance(
+	TEXT("course.AI.SignificanceDistance"),
+	AISignificanceDistance,
+	TEXT("Distance to the closest player at which an AI becomes dormant."));
+
+/** Seconds between significance updates. */
+static constexpr float SignificanceUpdateInterval = 0.25f;
+
+static const FCourseSignificanceSettings SignificanceSettings[] =
+{
+	// BehaviorInterval, TickInterval, NetUpdateScale, bShowWidget, bNavWalking
+	{ 0.f, 0.f, 1.f, true, false },
+	{ 0.1f, 0.033f, 0.5f, true, false },
+	{ 0.3f, 0.1f, 0.2f, false, true },
+	{ 1.f, 0.25f, 0.05f, false, true },
+};
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAISignificanceStress(
+	TEXT("course.AI.SignificanceStress"),
+	TEXT("Spawns copies of the first AI around the first player and logs the average frame time with significance on and off. Usage: course.AI.SignificanceStress 100 300 1000"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+		APawn* Player = PlayerController ? PlayerController->GetPawn() : nullptr;
+		TActorIterator<AAICharacter> It(World);
+
+		if (Player == nullptr || !It)
+		{
+			return;
+		}
+
+		TArray<int32> Counts;
+
+		for (const FString& Arg : Args)
+		{
+			Counts.Add(FCString::Atoi(*Arg));
+		}
+
+		if (Counts.Num() == 0)
+		{
+			Counts = { 100, 300, 1000 };
+		}
+
+		struct FStressRun
+		{
+			TWeakObjectPtr<UWorld> World;
+			UClass* AIClass = nullptr;
+			FVector Center;
+			TArray<int32> Counts;
+			TArray<TWeakObjectPtr<AAICharacter>> Spawned;
+			int32 Step = 0;
+			float FrameTime = 0.f;
+			int32 Frames = 0;
+			FTimerHandle Timer;
+			FDelegateHandle FrameHandle;
+		};
+
+		TSharedRef<FStressRun> Run = MakeShared<FStressRun>();
+		Run->World = World;
+		Run->AIClass = It->GetClass();
+		Run->Center = Player->GetActorLocation();
+		Run->Counts = Counts;
+
+		// Every count is measured twice, with significance on and then off, for a few seconds each
+		// Only the pending timer keeps the steps alive, so nothing is left behind after the last one
+		TSharedRef<TFunction<void()>> NextStep = MakeShared<TFunction<void()>>();
+		*NextStep = [Run, WeakNextStep = TWeakPtr<TFunction<void()>>(NextStep)]()
+		{
+			UWorld* StressWorld = Run->World.Get();
+
+			if (StressWorld == nullptr)
+			{
+				return;
+			}
+
+			if (Run->Frames > 0)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Significance stress %d spiders, significance %s: %.2f ms average frame"),
+					Run->Spawned.Num(), AISignificanceEnabled ? TEXT("on") : TEXT("off"), Run->FrameTime / Run->Frames * 1000.f);
+			}
+
+			if (Run->Step >= Run->Counts.Num() * 2)
+			{
+				for (const TWeakObjectPtr<AAICharacter>& Character : Run->Spawned)
+				{
+					if (Character.IsValid())
+					{
+						Character->Destroy();
+					}
+				}
+
+				AISignificanceEnabled = 1;
+				FWorldDelegates::OnWorldPostActorTick.Remove(Run->FrameHandle);
+				return;
+			}
+
+			const int32 Count = Run->Counts[Run->Step / 2];
+			AISignificanceEnabled = Run->Step % 2 == 0;
+			Run->Step++;
+
+			FRandomStream Random(Count);
+
+			while (Run->Spawned.Num() < Count)
+			{
+				const FVector Location = Run->Center + FVector(Random.FRandRange(-10000.f, 10000.f), Random.FRandRange(-10000.f, 10000.f), 100.f);
+				AAICharacter* Character = StressWorld->SpawnActor<AAICharacter>(Run->AIClass, Location, FRotator::ZeroRotator);
+
+				if (Character == nullptr)
+				{
+					break;
+				}
+
+				Character->SpawnDefaultController();
+				Run->Spawned.Add(Character);
+			}
+
+			Run->FrameTime = 0.f;
+			Run->Frames = 0;
+			StressWorld->GetTimerManager().SetTimer(Run->Timer, FTimerDelegate::CreateLambda([NextStep = WeakNextStep.Pin()]() { (*NextStep)(); }), 5.f, false);
+		};
+
+		Run->FrameHandle = FWorldDelegates::OnWorldPostActorTick.AddLambda([Run](UWorld* TickWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickWorld == Run->World.Get())
+			{
+				Run->FrameTime += DeltaSeconds;
+				Run->Frames++;
+			}
+		});
+
+		(*NextStep)();
+	}));
+
+bool UCourseSignificanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+const FCourseSignificanceSettings& UCourseSignificanceSubsystem::GetSettings(ECourseSignificance Significance)
+{
+	return SignificanceSettings[(uint8)Significance];
+}
+
+void UCourseSignificanceSubsystem::RegisterAI(AAICharacter* Character)
+{
+	Characters.AddUnique(Character);
+}
+
+void UCourseSignificanceSubsystem::UnregisterAI(AAICharacter* Character)
+{
+	Characters.RemoveSwap(Character);
+}
+
+TStatId UCourseSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UCourseSignificanceSubsystem::GatherViewpoints()
+{
+	Viewpoints.Reset();
+
+	// Server side player controllers know the view of their remote players as well
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+
+		if (PlayerController != nullptr && PlayerController->GetPawn() != nullptr)
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			Viewpoints.Add(FTransform(Rotation, Location));
+		}
+	}
+}
+
+ECourseSignificance UCourseSignificanceSubsystem::CalculateSignificance(const FVector& Location) const
+{
+	if (!AISignificanceEnabled || Viewpoints.Num() == 0)
+	{
+		return ECourseSignificance::High;
+	}
+
+	float BestScore = 0.f;
+
+	for (const FTransform& Viewpoint : Viewpoints)
+	{
+		const FVector ToAI = Location - Viewpoint.GetLocation();
+		const float Distance = ToAI.Size();
+		const float DistanceScore = 1.f - FMath::Min(Distance / AISignificanceDistance, 1.f);
+
+		// Spiders behind the camera count as half as close
+		const bool bInView = FVector::DotProduct(Viewpoint.GetRotation().GetForwardVector(), ToAI) > 0.f;
+		BestScore = FMath::Max(BestScore, bInView ? DistanceScore : DistanceScore * 0.5f);
+	}
+
+	if (BestScore > 0.66f)
+	{
+		return ECourseSignificance::High;
+	}
+	else if (BestScore > 0.33f)
+	{
+		return ECourseSignificance::Medium;
+	}
+	else if (BestScore > 0.f)
+	{
+		return ECourseSignificance::Low;
+	}
+
+	return ECourseSignificance::Dormant;
+}
+
+void UCourseSignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeUntilUpdate -= DeltaTime;
+
+	if (TimeUntilUpdate > 0.f)
+	{
+		return;
+	}
+
+	TimeUntilUpdate = SignificanceUpdateInterval;
+
+	SCOPE_CYCLE_COUNTER(STAT_AISignificance);
+
+	GatherViewpoints();
+	Characters.RemoveAllSwap([](const TWeakObjectPtr<AAICharacter>& Character) { return !Character.IsValid(); });
+
+	int32 NumHigh = 0;
+	int32 NumDormant = 0;
+
+	for (const TWeakObjectPtr<AAICharacter>& Character : Characters)
+	{
+		const ECourseSignificance Significance = CalculateSignificance(Character->GetActorLocation());
+		Character->SetSignificance(Significance);
+
+		NumHigh += Significance == ECourseSignificance::High;
+		NumDormant += Significance == ECourseSignificance::Dormant;
+	}
+
+	SET_DWORD_STAT(STAT_AIHighSignificance, NumHigh);
+	SET_DWORD_STAT(STAT_AIDormant, NumDormant);
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CourseSignificanceSubsystem.generated.h"
+
+class AAICharacter;
+
+UENUM(BlueprintType)
+enum class ECourseSignificance : uint8
+{
+	High,
+	Medium,
+	Low,
+	Dormant
+};
+
+/** What an AI runs at for one significance level. */
+struct FCourseSignificanceSettings
+{
+	/** Minimum seconds between behavior tree updates. */
+	float BehaviorInterval;
+
+	/** Tick interval of the actor, movement and mesh, 0 ticks every frame. */
+	float TickInterval;
+
+	/** Net update frequency as a fraction of the actor's default. */
+	float NetUpdateScale;
+
+	bool bShowWidget;
+	bool bNavWalking;
+};
+
+/**
+ * Scores every AI by distance and view direction to all players and buckets it into a significance level.
+ * Levels are re-evaluated a few times per second, AIs only reconfigure their components when their level changes.
+ */
+UCLASS()
+class UECOURSE_API UCourseSignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	void RegisterAI(AAICharacter* Character);
+	void UnregisterAI(AAICharacter* Character);
+
+	static const FCourseSignificanceSettings& GetSettings(ECourseSignificance Significance);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Characters.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	TArray<TWeakObjectPtr<AAICharacter>> Characters;
+	TArray<FTransform> Viewpoints;
+	float TimeUntilUpdate = 0.f;
+
+	void GatherViewpoints();
+	ECourseSignificance CalculateSignificance(const FVector& Location) const;
+};
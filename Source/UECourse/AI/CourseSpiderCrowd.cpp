@@ -0,0 +1,420 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseSpiderCrowd.h"
+#include "../UECourse.h"
+#include "../UECourseCharacter.h"
+#include "../Core/CourseActorRegistrySubsystem.h"
+#include "AICharacter.h"
+#include "CoursePatrolPointSubsystem.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Simulate"), STAT_CrowdSimulate, STATGROUP_UECourse);
+DECLARE_CYCLE_STAT(TEXT("Crowd Promotion"), STAT_CrowdPromotion, STATGROUP_UECourse);
+DECLARE_CYCLE_STAT(TEXT("Crowd Instances"), STAT_CrowdInstances, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Spiders"), STAT_CrowdSpiders, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Promoted"), STAT_CrowdPromoted, STATGROUP_UECourse);
+
+/** Spiders per parallel simulation task. */
+static constexpr int32 CrowdBatchSize = 512;
+
+ACourseSpiderCrowd::ACourseSpiderCrowd()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetCastShadow(false);
+	RootComponent = Instances;
+}
+
+void ACourseSpiderCrowd::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The crowd is simulated and drawn by the server only, remote clients see just the promoted characters
+	if (!HasAuthority())
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	Random.GenerateNewSeed();
+
+	Positions.SetNumUninitialized(NumSpiders);
+	Velocities.SetNumZeroed(NumSpiders);
+	PatrolTargets.SetNumUninitialized(NumSpiders);
+	HP.Init(100, NumSpiders);
+	StunTimers.SetNumZeroed(NumSpiders);
+	States.Init(EAgentState::Unplaced, NumSpiders);
+
+	const FVector Origin = GetActorLocation();
+
+	// Scattered around the crowd, each spider is put on the navmesh by the patrol point queries over the next frames
+	for (int32 i = 0; i < NumSpiders; i++)
+	{
+		Positions[i] = Origin + FVector(Random.FRandRange(-SpawnRadius, SpawnRadius), Random.FRandRange(-SpawnRadius, SpawnRadius), 0.f);
+		PatrolTargets[i] = Positions[i];
+	}
+
+	SET_DWORD_STAT(STAT_CrowdSpiders, NumSpiders);
+
+	// Nobody looks at a dedicated server's instances
+	bDrawInstances = GetNetMode() != NM_DedicatedServer;
+
+	if (bDrawInstances)
+	{
+		// Instances are kept in world space, placing the component at the origin makes local and world space the same
+		Instances->SetWorldTransform(FTransform::Identity);
+
+		// Unplaced spiders start hidden
+		InstanceTransforms.Init(FTransform(FRotator::ZeroRotator, Origin, FVector::ZeroVector), NumSpiders);
+		DirtyInstanceBatches.Init(false, FMath::DivideAndRoundUp(NumSpiders, CrowdBatchSize));
+		Instances->AddInstances(InstanceTransforms, false);
+	}
+}
+
+void ACourseSpiderCrowd::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (const TPair<int32, TWeakObjectPtr<AAICharacter>>& Pair : Promoted)
+	{
+		if (AAICharacter* Character = Pair.Value.Get())
+		{
+			if (AController* Controller = Character->GetController())
+			{
+				Controller->Destroy();
+			}
+
+			Character->Destroy();
+		}
+	}
+
+	Promoted.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACourseSpiderCrowd::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	PlayerLocations.Reset();
+
+	if (UCourseActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UCourseActorRegistrySubsystem>())
+	{
+		Registry->ForEachActorOfClass(AUECourseCharacter::StaticClass(), [this](AActor* Player)
+		{
+			PlayerLocations.Add(Player->GetActorLocation());
+			return true;
+		});
+	}
+
+	SimulateAgents(DeltaTime);
+	PickPatrolTargets();
+	DemoteAgents();
+	PromoteAgents();
+	UpdateInstances();
+}
+
+void ACourseSpiderCrowd::SimulateAgents(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CrowdSimulate);
+
+	const int32 Num = Positions.Num();
+	const int32 NumBatches = FMath::DivideAndRoundUp(Num, CrowdBatchSize);
+	const float PromoteDistSq = FMath::Square(PromoteDistance);
+	const float DemoteDistSq = FMath::Square(DemoteDistance);
+
+	// Every spider only writes its own entries, so batches run without locks
+	ParallelFor(NumBatches, [&](int32 Batch)
+	{
+		const int32 End = FMath::Min((Batch + 1) * CrowdBatchSize, Num);
+
+		for (int32 i = Batch * CrowdBatchSize; i < End; i++)
+		{
+			if (States[i] == EAgentState::Dead || States[i] == EAgentState::Unplaced || States[i] == EAgentState::Placing)
+			{
+				continue;
+			}
+
+			float NearestPlayerDistSq = TNumericLimits<float>::Max();
+
+			for (const FVector& PlayerLocation : PlayerLocations)
+			{
+				NearestPlayerDistSq = FMath::Min(NearestPlayerDistSq, FVector::DistSquared(Positions[i], PlayerLocation));
+			}
+
+			if (States[i] == EAgentState::Promoted)
+			{
+				if (NearestPlayerDistSq > DemoteDistSq)
+				{
+					States[i] = EAgentState::WantsDemotion;
+				}
+
+				continue;
+			}
+
+			if (NearestPlayerDistSq < PromoteDistSq)
+			{
+				States[i] = EAgentState::WantsPromotion;
+				continue;
+			}
+
+			if (StunTimers[i] > 0.f)
+			{
+				StunTimers[i] = FMath::Max(StunTimers[i] - DeltaTime, 0.f);
+				Velocities[i] = FVector::ZeroVector;
+				continue;
+			}
+
+			if (States[i] == EAgentState::WaitingForTarget)
+			{
+				continue;
+			}
+
+			const FVector ToTarget = PatrolTargets[i] - Positions[i];
+			const float Distance = ToTarget.Size();
+			const float Step = Speed * DeltaTime;
+
+			if (Distance <= Step)
+			{
+				Positions[i] = PatrolTargets[i];
+				Velocities[i] = FVector::ZeroVector;
+				States[i] = EAgentState::NeedsTarget;
+			}
+			else
+			{
+				Velocities[i] = ToTarget / Distance * Speed;
+				Positions[i] += Velocities[i] * DeltaTime;
+			}
+		}
+	});
+}
+
+void ACourseSpiderCrowd::PickPatrolTargets()
+{
+	UCoursePatrolPointSubsystem* PatrolPoints = GetWorld()->GetSubsystem<UCoursePatrolPointSubsystem>();
+	int32 Retargets = 0;
+
+	for (int32 i = 0; i < States.Num() && Retargets < MaxRetargetsPerFrame; i++)
+	{
+		if (States[i] != EAgentState::Unplaced && States[i] != EAgentState::NeedsTarget)
+		{
+			continue;
+		}
+
+		States[i] = States[i] == EAgentState::Unplaced ? EAgentState::Placing : EAgentState::WaitingForTarget;
+		Retargets++;
+
+		FVector Location;
+
+		if (PatrolPoints == nullptr)
+		{
+			HandlePatrolPoint(false, Positions[i], i);
+		}
+		else if (PatrolPoints->TryGetCachedPoint(Positions[i], PatrolRadius, Location))
+		{
+			HandlePatrolPoint(true, Location, i);
+		}
+		else
+		{
+			// Navmesh queries are spread over frames by the patrol point budget
+			PatrolPoints->RequestPoint(Positions[i], PatrolRadius, FCourseOnPatrolPoint::CreateUObject(this, &ACourseSpiderCrowd::HandlePatrolPoint, i));
+		}
+	}
+}
+
+void ACourseSpiderCrowd::HandlePatrolPoint(bool bSuccess, const FVector& Location, int32 Index)
+{
+	if (!States.IsValidIndex(Index))
+	{
+		return;
+	}
+
+	// Spiders promoted or killed while they waited keep their state
+	if (States[Index] == EAgentState::Placing)
+	{
+		// Without a navigable point the spider stays where it was scattered
+		if (bSuccess)
+		{
+			Positions[Index] = Location;
+		}
+
+		PatrolTargets[Index] = Positions[Index];
+		States[Index] = EAgentState::NeedsTarget;
+	}
+	else if (States[Index] == EAgentState::WaitingForTarget)
+	{
+		PatrolTargets[Index] = bSuccess ? Location : Positions[Index];
+		States[Index] = EAgentState::Simulated;
+	}
+}
+
+void ACourseSpiderCrowd::PromoteAgents()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CrowdPromotion);
+
+	int32 Promotions = 0;
+
+	for (int32 i = 0; i < States.Num(); i++)
+	{
+		if (States[i] != EAgentState::WantsPromotion)
+		{
+			continue;
+		}
+
+		if (Promotions < MaxPromotionsPerFrame)
+		{
+			Promote(i);
+			Promotions++;
+		}
+		else
+		{
+			// Keep walking until a promotion slot frees up
+			States[i] = EAgentState::Simulated;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_CrowdPromoted, Promoted.Num());
+}
+
+void ACourseSpiderCrowd::Promote(int32 Index)
+{
+	if (AIClass == nullptr)
+	{
+		States[Index] = EAgentState::Simulated;
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	const FRotator Rotation = Velocities[Index].IsNearlyZero() ? FRotator::ZeroRotator : Velocities[Index].Rotation();
+	AAICharacter* Character = GetWorld()->SpawnActor<AAICharacter>(AIClass, Positions[Index], Rotation, SpawnParameters);
+
+	if (Character == nullptr)
+	{
+		States[Index] = EAgentState::Simulated;
+		return;
+	}
+
+	Character->CurrentHP = HP[Index];
+	Character->SpawnDefaultController();
+
+	if (StunTimers[Index] > 0.f)
+	{
+		Character->Stun();
+	}
+
+	Promoted.Add(Index, Character);
+	States[Index] = EAgentState::Promoted;
+}
+
+void ACourseSpiderCrowd::DemoteAgents()
+{
+	for (auto It = Promoted.CreateIterator(); It; ++It)
+	{
+		const int32 Index = It.Key();
+		AAICharacter* Character = It.Value().Get();
+
+		// Killed or removed while it was a character
+		if (Character == nullptr || !Character->IsAlive())
+		{
+			States[Index] = EAgentState::Dead;
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (States[Index] == EAgentState::WantsDemotion)
+		{
+			Demote(Index, Character);
+			It.RemoveCurrent();
+		}
+		else
+		{
+			Positions[Index] = Character->GetActorLocation();
+		}
+	}
+}
+
+void ACourseSpiderCrowd::Demote(int32 Index, AAICharacter* Character)
+{
+	Positions[Index] = Character->GetActorLocation();
+	HP[Index] = Character->CurrentHP;
+	StunTimers[Index] = Character->IsStunned ? 3.f : 0.f;
+	States[Index] = EAgentState::NeedsTarget;
+
+	if (AController* Controller = Character->GetController())
+	{
+		Controller->Destroy();
+	}
+
+	Character->Destroy();
+}
+
+void ACourseSpiderCrowd::UpdateInstances()
+{
+	if (!bDrawInstances)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_CrowdInstances);
+
+	const int32 Num = Positions.Num();
+	const int32 NumBatches = FMath::DivideAndRoundUp(Num, CrowdBatchSize);
+
+	ParallelFor(NumBatches, [&](int32 Batch)
+	{
+		const int32 End = FMath::Min((Batch + 1) * CrowdBatchSize, Num);
+		bool bDirty = false;
+
+		for (int32 i = Batch * CrowdBatchSize; i < End; i++)
+		{
+			// Promoted, dead and unplaced spiders are hidden by collapsing their instance
+			const bool bVisible = States[i] != EAgentState::Promoted && States[i] != EAgentState::Dead && States[i] != EAgentState::Unplaced && States[i] != EAgentState::Placing;
+			const FRotator Rotation = Velocities[i].IsNearlyZero() ? InstanceTransforms[i].Rotator() : Velocities[i].Rotation();
+			const FTransform Transform(Rotation, Positions[i], bVisible ? FVector::OneVector : FVector::ZeroVector);
+
+			if (!Transform.Equals(InstanceTransforms[i]))
+			{
+				InstanceTransforms[i] = Transform;
+				bDirty = true;
+			}
+		}
+
+		DirtyInstanceBatches[Batch] = bDirty;
+	});
+
+	// Only runs of batches with a moved spider are sent to the component
+	TArray<FTransform> RangeTransforms;
+	bool bUpdated = false;
+
+	for (int32 Batch = 0; Batch < NumBatches; Batch++)
+	{
+		if (!DirtyInstanceBatches[Batch])
+		{
+			continue;
+		}
+
+		const int32 FirstBatch = Batch;
+
+		while (Batch + 1 < NumBatches && DirtyInstanceBatches[Batch + 1])
+		{
+			Batch++;
+		}
+
+		const int32 Start = FirstBatch * CrowdBatchSize;
+		const int32 End = FMath::Min((Batch + 1) * CrowdBatchSize, Num);
+
+		RangeTransforms.Reset();
+		RangeTransforms.Append(InstanceTransforms.GetData() + Start, End - Start);
+		Instances->BatchUpdateInstancesTransforms(Start, RangeTransforms, false, false, true);
+		bUpdated = true;
+	}
+
+	if (bUpdated)
+	{
+		Instances->MarkRenderStateDirty();
+	}
+}
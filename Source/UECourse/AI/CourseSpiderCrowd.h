@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "CourseSpiderCrowd.generated.h"
+
+class AAICharacter;
+
+/**
+ * Simulates distant spiders as plain data on the server and draws them as mesh instances, unless the server is dedicated.
+ * A spider within PromoteDistance of a player is replaced by a real AI character, and turned back into
+ * crowd data once every player is beyond DemoteDistance again.
+ * Remote clients are not supported: nothing of the crowd is replicated, so they only see the promoted characters
+ * and none of the distant spiders. Use it in standalone or on a listen server's local player.
+ */
+UCLASS()
+class UECOURSE_API ACourseSpiderCrowd : public AActor
+{
+	GENERATED_BODY()
+	
+public:	
+	ACourseSpiderCrowd();
+	virtual void Tick(float DeltaTime) override;
+
+	int32 GetNumSpiders() const { return Positions.Num(); }
+	int32 GetNumPromoted() const { return Promoted.Num(); }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Components")
+	UInstancedStaticMeshComponent* Instances;
+
+	/** Spawned for promoted spiders, its AI controller class is used to possess it. */
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	TSubclassOf<AAICharacter> AIClass;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	int32 NumSpiders = 10000;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	float SpawnRadius = 20000.f;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	float PatrolRadius = 1500.f;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	float Speed = 200.f;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	float PromoteDistance = 2500.f;
+
+	/** Larger than PromoteDistance so spiders at the edge do not flip every frame. */
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	float DemoteDistance = 3000.f;
+
+	/** Spawning characters is expensive, promotions beyond this wait for the next frames. */
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	int32 MaxPromotionsPerFrame = 8;
+
+	/** Spawn points and patrol targets requested per frame, the rest of the spiders wait in place. */
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	int32 MaxRetargetsPerFrame = 256;
+
+private:
+	enum class EAgentState : uint8
+	{
+		Unplaced,
+		Placing,
+		Simulated,
+		WantsPromotion,
+		Promoted,
+		WantsDemotion,
+		NeedsTarget,
+		WaitingForTarget,
+		Dead
+	};
+
+	// One entry per spider, kept in separate arrays so each pass only touches the data it needs
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<FVector> PatrolTargets;
+	TArray<int32> HP;
+	TArray<float> StunTimers;
+	TArray<EAgentState> States;
+
+	TArray<FTransform> InstanceTransforms;
+	TArray<bool> DirtyInstanceBatches;
+	bool bDrawInstances = false;
+	TMap<int32, TWeakObjectPtr<AAICharacter>> Promoted;
+	TArray<FVector> PlayerLocations;
+	FRandomStream Random;
+
+	void SimulateAgents(float DeltaTime);
+	void PickPatrolTargets();
+	void PromoteAgents();
+	void DemoteAgents();
+	void UpdateInstances();
+
+	void HandlePatrolPoint(bool bSuccess, const FVector& Location, int32 Index);
+	void Promote(int32 Index);
+	void Demote(int32 Index, AAICharacter* Character);
+};
@@ -2,21 +2,34 @@
 
 
 #include "BTDecorator_CheckStun.h"
+#include "../CourseAIBenchmark.h"
 #include "../CourseAIController.h"
 #include "../AICharacter.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+UBTDecorator_CheckStun::UBTDecorator_CheckStun(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	BlackboardKey.SelectedKeyName = ACourseAIController::StunnedKey;
+	BlackboardKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UBTDecorator_CheckStun, BlackboardKey));
+
+	// A stun preempts lower priority branches and ends the stunned one, nodes that set their own mode in the tree keep it
+	FlowAbortMode = EBTFlowAbortMode::Both;
+}
 
 bool UBTDecorator_CheckStun::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
-	if (ACourseAIController* Controller = Cast<ACourseAIController>(OwnerComp.GetAIOwner()))
-	{
-		AAICharacter* Character = Cast<AAICharacter>(Controller->GetPawn());
+	COURSE_AI_PROFILE_SCOPE("CheckStun");
 
-		if (Character != nullptr)
-		{
-			return Character->IsStunned;
-		}
-		
+	const UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+
+	if (Blackboard != nullptr && BlackboardKey.IsSet())
+	{
+		return Blackboard->GetValueAsBool(BlackboardKey.SelectedKeyName);
 	}
 
-	return false;
-}
\ No newline at end of file
+	// The key did not resolve in this blackboard asset, so ask the pawn like before
+	const ACourseAIController* Controller = Cast<ACourseAIController>(OwnerComp.GetAIOwner());
+	const AAICharacter* Character = Controller != nullptr ? Cast<AAICharacter>(Controller->GetPawn()) : nullptr;
+
+	return Character != nullptr && Character->IsStunned;
+}
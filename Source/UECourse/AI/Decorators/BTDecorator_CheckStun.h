@@ -6,10 +6,16 @@
 #include "BehaviorTree/Decorators/BTDecorator_BlackboardBase.h"
 #include "BTDecorator_CheckStun.generated.h"
 
+/**
+ * Passes while the pawn is stunned. Reads the bool the AI character publishes to the blackboard and aborts as soon as it changes.
+ * ACourseAIController adds the key to its blackboard, with any other blackboard lacking it the pawn is asked instead and nothing aborts.
+ */
 UCLASS()
 class UECOURSE_API UBTDecorator_CheckStun : public UBTDecorator_BlackboardBase
 {
 	GENERATED_BODY()
-	
+
+	UBTDecorator_CheckStun(const FObjectInitializer& ObjectInitializer);
+
 	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
 };
@@ -2,24 +2,34 @@
 
 
 #include "BTDecorator_IsAlive.h"
+#include "../CourseAIBenchmark.h"
 #include "../CourseAIController.h"
 #include "../AICharacter.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+UBTDecorator_IsAlive::UBTDecorator_IsAlive(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	BlackboardKey.SelectedKeyName = ACourseAIController::AliveKey;
+	BlackboardKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UBTDecorator_IsAlive, BlackboardKey));
+
+	// Death ends the branch it guards, nodes that set their own mode in the tree keep it
+	FlowAbortMode = EBTFlowAbortMode::Self;
+}
 
 bool UBTDecorator_IsAlive::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
-	if (ACourseAIController* Controller = Cast<ACourseAIController>(OwnerComp.GetAIOwner()))
+	COURSE_AI_PROFILE_SCOPE("IsAlive");
+
+	const UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+
+	if (Blackboard != nullptr && BlackboardKey.IsSet())
 	{
-		AAICharacter* Character = Cast<AAICharacter>(Controller->GetPawn());
-
-		if (Character != nullptr)
-		{
-			if (Character->CurrentHP == 0)
-			{
-				Character->IsStunned = true;
-				return false;
-			}
-		}
+		return Blackboard->GetValueAsBool(BlackboardKey.SelectedKeyName);
 	}
 
-	return true;
-}
\ No newline at end of file
+	// The key did not resolve in this blackboard asset, so ask the pawn like before
+	const ACourseAIController* Controller = Cast<ACourseAIController>(OwnerComp.GetAIOwner());
+	const AAICharacter* Character = Controller != nullptr ? Cast<AAICharacter>(Controller->GetPawn()) : nullptr;
+
+	return Character == nullptr || Character->IsAlive();
+}
@@ -6,11 +6,16 @@
 #include "BehaviorTree/Decorators/BTDecorator_BlackboardBase.h"
 #include "BTDecorator_IsAlive.generated.h"
 
-
+/**
+ * Passes while the pawn is alive. Reads the bool the AI character publishes to the blackboard and aborts as soon as it changes.
+ * ACourseAIController adds the key to its blackboard, with any other blackboard lacking it the pawn is asked instead and nothing aborts.
+ */
 UCLASS()
 class UECOURSE_API UBTDecorator_IsAlive : public UBTDecorator_BlackboardBase
 {
 	GENERATED_BODY()
-	
+
+	UBTDecorator_IsAlive(const FObjectInitializer& ObjectInitializer);
+
 	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
 };
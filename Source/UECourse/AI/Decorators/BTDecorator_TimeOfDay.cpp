@@ -2,25 +2,53 @@
 
 
 #include "BTDecorator_TimeOfDay.h"
-#include "Kismet/GameplayStatics.h"
-#include "../CourseAIController.h"
-#include "../../UECourseCharacter.h"
-#include "../AICharacter.h"
-#include "Kismet/KismetSystemLibrary.h"
-#include "NavigationSystem.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "BehaviorTree/BlackboardComponent.h"
-#include "../../UECourseGameMode.h"
+#include "../CourseAIBenchmark.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "../../Core/CourseTimeOfDaySubsystem.h"
+
+UBTDecorator_TimeOfDay::UBTDecorator_TimeOfDay(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	bNotifyBecomeRelevant = true;
+	bNotifyCeaseRelevant = true;
+}
 
 bool UBTDecorator_TimeOfDay::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
-	if (AUECourseGameMode* GameMode = Cast<AUECourseGameMode>(UGameplayStatics::GetGameMode(GetWorld())))
+	COURSE_AI_PROFILE_SCOPE("TimeOfDay");
+
+	if (UCourseTimeOfDaySubsystem* TimeOfDay = OwnerComp.GetWorld()->GetSubsystem<UCourseTimeOfDaySubsystem>())
 	{
-		if (FMath::Floor(GameMode->Hour) >= StartOfActivity && FMath::Floor(GameMode->Hour) < EndOfActivity)
-		{
-			return true;
-		}
+		const float Hour = FMath::Floor(TimeOfDay->GetHour());
+		return Hour >= StartOfActivity && Hour < EndOfActivity;
 	}
 
 	return false;
-}
\ No newline at end of file
+}
+
+void UBTDecorator_TimeOfDay::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+
+	if (UCourseTimeOfDaySubsystem* TimeOfDay = OwnerComp.GetWorld()->GetSubsystem<UCourseTimeOfDaySubsystem>())
+	{
+		FBTTimeOfDayDecoratorMemory* Memory = CastInstanceNodeMemory<FBTTimeOfDayDecoratorMemory>(NodeMemory);
+		UBehaviorTreeComponent* OwnerCompPtr = &OwnerComp;
+
+		Memory->HourChangedHandle = TimeOfDay->OnHourChanged.AddWeakLambda(OwnerCompPtr, [this, OwnerCompPtr](int32 Hour)
+		{
+			ConditionalFlowAbort(*OwnerCompPtr, EBTDecoratorAbortRequest::ConditionResultChanged);
+		});
+	}
+}
+
+void UBTDecorator_TimeOfDay::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	if (UCourseTimeOfDaySubsystem* TimeOfDay = OwnerComp.GetWorld()->GetSubsystem<UCourseTimeOfDaySubsystem>())
+	{
+		FBTTimeOfDayDecoratorMemory* Memory = CastInstanceNodeMemory<FBTTimeOfDayDecoratorMemory>(NodeMemory);
+		TimeOfDay->OnHourChanged.Remove(Memory->HourChangedHandle);
+		Memory->HourChangedHandle.Reset();
+	}
+
+	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+}
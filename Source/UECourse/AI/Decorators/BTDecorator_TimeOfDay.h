@@ -6,11 +6,22 @@
 #include "BehaviorTree/Decorators/BTDecorator_BlackboardBase.h"
 #include "BTDecorator_TimeOfDay.generated.h"
 
+struct FBTTimeOfDayDecoratorMemory
+{
+	FDelegateHandle HourChangedHandle;
+};
+
+/**
+ * Passes while the game hour is within the activity window.
+ * Observes hour changes while relevant instead of being evaluated on every tick.
+ */
 UCLASS()
 class UECOURSE_API UBTDecorator_TimeOfDay : public UBTDecorator_BlackboardBase
 {
 	GENERATED_BODY()
 
+	UBTDecorator_TimeOfDay(const FObjectInitializer& ObjectInitializer);
+
 	UPROPERTY(EditAnywhere, Category = Condition, meta = (ClampMin = "0.0", ClampMax = "24.0"))
 	float StartOfActivity;
 
@@ -18,4 +29,7 @@ class UECOURSE_API UBTDecorator_TimeOfDay : public UBTDecorator_BlackboardBase
 	float EndOfActivity;
 
 	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTTimeOfDayDecoratorMemory); }
 };
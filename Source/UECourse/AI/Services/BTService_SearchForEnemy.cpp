@@ -3,11 +3,9 @@
 
 #include "BTService_SearchForEnemy.h"
 #include "../CourseAIController.h"
-#include "../../UECourseCharacter.h"
 #include "../AICharacter.h"
-#include "Kismet/KismetSystemLibrary.h"
-#include "NavigationSystem.h"
-#include "GameFramework/CharacterMovementComponent.h"
+#include "../CoursePerceptionSubsystem.h"
+#include "../CourseAIBenchmark.h"
 #include "BehaviorTree/BlackboardComponent.h"
 
 UBTService_SearchForEnemy::UBTService_SearchForEnemy(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
@@ -19,7 +17,8 @@ UBTService_SearchForEnemy::UBTService_SearchForEnemy(const FObjectInitializer& O
 
 void UBTService_SearchForEnemy::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
-	bool Seen = false;
+	COURSE_AI_PROFILE_SCOPE("SearchForEnemy");
+
 	ACourseAIController* Controller = Cast<ACourseAIController>(OwnerComp.GetOwner());
 
 	if (Controller == nullptr)
@@ -34,29 +33,19 @@ void UBTService_SearchForEnemy::TickNode(UBehaviorTreeComponent& OwnerComp, uint
 		return;
 	}
 
-	float PatrolRadius = Controller->GetPatrolRadius();
-	FVector Start = Character->GetActorLocation();
-	TArray<FHitResult> OutHits;
-	TArray<TEnumAsByte<EObjectTypeQuery>> TraceObjectTypes;
-	TraceObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECollisionChannel::ECC_Pawn));
-	UKismetSystemLibrary::SphereTraceMultiForObjects(GetWorld(), Start, Start, PatrolRadius, TraceObjectTypes, false, TArray<AActor*>(), EDrawDebugTrace::None, OutHits, true);
+	UCoursePerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UCoursePerceptionSubsystem>();
 
-	for (FHitResult& HitResult : OutHits)
+	if (Perception == nullptr)
 	{
-		if (HitResult.Actor != nullptr)
-		{
-			AUECourseCharacter* Enemy = Cast<AUECourseCharacter>(HitResult.Actor);
-
-			if (Enemy != nullptr)
-			{
-				Controller->GetBlackboardComponent()->SetValueAsObject(EnemyKey.SelectedKeyName, Enemy);
-				Seen = true;
-			}
-		}
+		return;
 	}
 
-	if (!Seen)
+	AActor* Enemy = Perception->FindNearestEnemy(Character->GetActorLocation(), Controller->GetPatrolRadius());
+	UBlackboardComponent* Blackboard = Controller->GetBlackboardComponent();
+
+	// Only touch the blackboard when the detected enemy changes
+	if (Blackboard->GetValueAsObject(EnemyKey.SelectedKeyName) != Enemy)
 	{
-		Controller->GetBlackboardComponent()->SetValueAsObject(Controller->GetDetectedEnemyKey(), nullptr);
+		Blackboard->SetValueAsObject(EnemyKey.SelectedKeyName, Enemy);
 	}
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "../CourseAIController.h"
 #include "../../UECourseCharacter.h"
 #include "../AICharacter.h"
+#include "../CourseAIBenchmark.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "NavigationSystem.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -12,6 +13,8 @@
 
 void UBTService_SetSpeed::OnSearchStart(FBehaviorTreeSearchData& SearchData)
 {
+	COURSE_AI_PROFILE_SCOPE("SetSpeed");
+
 	ACourseAIController* Controller = Cast<ACourseAIController>(SearchData.OwnerComp.GetOwner());
 	AAICharacter* Character = Cast<AAICharacter>(Controller->GetPawn());
 
@@ -4,12 +4,15 @@
 #include "BTTask_Attack.h"
 #include "../CourseAIController.h"
 #include "../AICharacter.h"
+#include "../CourseAIBenchmark.h"
 #include "NavigationSystem.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
 
 EBTNodeResult::Type UBTTask_Attack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
+	COURSE_AI_PROFILE_SCOPE("Attack");
+
 	ACourseAIController* Controller = Cast<ACourseAIController>(OwnerComp.GetOwner());
 	
 	if (Controller != nullptr)
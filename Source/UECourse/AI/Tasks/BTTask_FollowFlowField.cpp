@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_FollowFlowField.h"
+#include "../CourseFlowFieldSubsystem.h"
+#include "../CourseAIBenchmark.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+UBTTask_FollowFlowField::UBTTask_FollowFlowField(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	NodeName = "Follow Flow Field";
+	bNotifyTick = true;
+
+	BlackboardKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_FollowFlowField, BlackboardKey), AActor::StaticClass());
+}
+
+EBTNodeResult::Type UBTTask_FollowFlowField::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* Controller = OwnerComp.GetAIOwner();
+	const AActor* Target = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValueAsObject(BlackboardKey.SelectedKeyName));
+
+	if (Controller == nullptr || Controller->GetPawn() == nullptr || Target == nullptr)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	// Time spent waiting for the field
+	*reinterpret_cast<float*>(NodeMemory) = 0.f;
+
+	return EBTNodeResult::InProgress;
+}
+
+void UBTTask_FollowFlowField::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	COURSE_AI_PROFILE_SCOPE("FollowFlowField");
+
+	AAIController* Controller = OwnerComp.GetAIOwner();
+	APawn* Pawn = Controller != nullptr ? Controller->GetPawn() : nullptr;
+	AActor* Target = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValueAsObject(BlackboardKey.SelectedKeyName));
+	UCourseFlowFieldSubsystem* FlowFields = OwnerComp.GetWorld()->GetSubsystem<UCourseFlowFieldSubsystem>();
+
+	if (Pawn == nullptr || Target == nullptr || FlowFields == nullptr)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	if (FVector::DistSquared2D(Pawn->GetActorLocation(), Target->GetActorLocation()) <= FMath::Square(AcceptanceRadius))
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+		return;
+	}
+
+	FVector Direction;
+
+	if (!FlowFields->GetFlowDirection(Target, Pawn->GetActorLocation(), Direction))
+	{
+		float& WaitTime = *reinterpret_cast<float*>(NodeMemory);
+		WaitTime += DeltaSeconds;
+
+		if (WaitTime > FieldTimeout)
+		{
+			FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		}
+
+		return;
+	}
+
+	Pawn->AddMovementInput(Direction);
+}
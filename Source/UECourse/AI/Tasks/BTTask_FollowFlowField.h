@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "BTTask_FollowFlowField.generated.h"
+
+/**
+ * Moves toward the actor in the blackboard key by following the shared flow field of that actor.
+ * Fails when the pawn is outside of the field, so a regular move task can take over.
+ */
+UCLASS()
+class UECOURSE_API UBTTask_FollowFlowField : public UBTTask_BlackboardBase
+{
+	GENERATED_BODY()
+
+	UBTTask_FollowFlowField(const FObjectInitializer& ObjectInitializer);
+
+	UPROPERTY(EditAnywhere, Category = Default)
+	float AcceptanceRadius = 150.f;
+
+	/** Seconds to wait for the field to be built before giving up. */
+	UPROPERTY(EditAnywhere, Category = Default)
+	float FieldTimeout = 0.5f;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(float); }
+};
@@ -3,9 +3,8 @@
 
 #include "BTTask_GetRandomPoint.h"
 #include "../CourseAIController.h"
-#include "../AICharacter.h"
-#include "NavigationSystem.h"
-#include "GameFramework/CharacterMovementComponent.h"
+#include "../CoursePatrolPointSubsystem.h"
+#include "../CourseAIBenchmark.h"
 #include "BehaviorTree/BlackboardComponent.h"
 
 UBTTask_GetRandomPoint::UBTTask_GetRandomPoint(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
@@ -18,30 +17,60 @@ UBTTask_GetRandomPoint::UBTTask_GetRandomPoint(const FObjectInitializer& ObjectI
 
 EBTNodeResult::Type UBTTask_GetRandomPoint::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
+	COURSE_AI_PROFILE_SCOPE("GetRandomPoint");
+
+	FBTGetRandomPointMemory* Memory = CastInstanceNodeMemory<FBTGetRandomPointMemory>(NodeMemory);
+	Memory->RequestId = INDEX_NONE;
+
 	ACourseAIController* Controller = Cast<ACourseAIController>(OwnerComp.GetOwner());
-	if (Controller == nullptr)
+	if (Controller == nullptr || Controller->GetPawn() == nullptr)
 	{
-		EBTNodeResult::Failed;
+		return EBTNodeResult::Failed;
 	}
 
+	UCoursePatrolPointSubsystem* PatrolPoints = OwnerComp.GetWorld()->GetSubsystem<UCoursePatrolPointSubsystem>();
 	float PatrolRadius = Controller->GetPatrolRadius();
 
-	if (PatrolRadius > 0.f)
+	if (PatrolPoints == nullptr || PatrolRadius <= 0.f)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	FVector Location;
+
+	if (PatrolPoints->TryGetCachedPoint(Controller->GetNavAgentLocation(), PatrolRadius, Location))
 	{
-		FNavLocation ResultLocation;
+		Controller->GetBlackboardComponent()->SetValueAsVector(Controller->GetLocationKey(), Location);
+		return EBTNodeResult::Succeeded;
+	}
+
+	UBehaviorTreeComponent* OwnerCompPtr = &OwnerComp;
 
-		if (UNavigationSystemV1::GetNavigationSystem(&OwnerComp)->GetRandomReachablePointInRadius(Controller->GetNavAgentLocation(), PatrolRadius, ResultLocation))
+	Memory->RequestId = PatrolPoints->RequestPoint(Controller->GetNavAgentLocation(), PatrolRadius, FCourseOnPatrolPoint::CreateWeakLambda(OwnerCompPtr,
+		[this, OwnerCompPtr, Memory, Controller](bool bSuccess, const FVector& Result)
 		{
-			AAICharacter* Character = Cast<AAICharacter>(Controller->GetPawn());
-			if (Character == nullptr)
+			Memory->RequestId = INDEX_NONE;
+
+			if (bSuccess)
 			{
-				EBTNodeResult::Failed;
+				Controller->GetBlackboardComponent()->SetValueAsVector(Controller->GetLocationKey(), Result);
 			}
 
-			Controller->GetBlackboardComponent()->SetValueAsVector(Controller->GetLocationKey(), ResultLocation.Location);
+			FinishLatentTask(*OwnerCompPtr, bSuccess ? EBTNodeResult::Succeeded : EBTNodeResult::Failed);
+		}));
+
+	return EBTNodeResult::InProgress;
+}
 
-			return EBTNodeResult::Succeeded;
-		}
+EBTNodeResult::Type UBTTask_GetRandomPoint::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FBTGetRandomPointMemory* Memory = CastInstanceNodeMemory<FBTGetRandomPointMemory>(NodeMemory);
+
+	if (UCoursePatrolPointSubsystem* PatrolPoints = OwnerComp.GetWorld()->GetSubsystem<UCoursePatrolPointSubsystem>())
+	{
+		PatrolPoints->CancelRequest(Memory->RequestId);
 	}
-	return EBTNodeResult::Failed;
+
+	Memory->RequestId = INDEX_NONE;
+	return EBTNodeResult::Aborted;
 }
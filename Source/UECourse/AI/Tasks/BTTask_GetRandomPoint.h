@@ -6,6 +6,15 @@
 #include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
 #include "BTTask_GetRandomPoint.generated.h"
 
+struct FBTGetRandomPointMemory
+{
+	int32 RequestId;
+};
+
+/**
+ * Picks a random reachable point within the controller's patrol radius.
+ * Answered from the patrol point cache when possible, otherwise waits for the queued navmesh query.
+ */
 UCLASS()
 class UECOURSE_API UBTTask_GetRandomPoint : public UBTTask_BlackboardBase
 {
@@ -17,4 +26,6 @@ class UECOURSE_API UBTTask_GetRandomPoint : public UBTTask_BlackboardBase
 	FBlackboardKeySelector LocationKey;
 
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTGetRandomPointMemory); }
 };
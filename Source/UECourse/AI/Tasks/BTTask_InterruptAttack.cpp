@@ -4,12 +4,15 @@
 #include "BTTask_InterruptAttack.h"
 #include "../CourseAIController.h"
 #include "../AICharacter.h"
+#include "../CourseAIBenchmark.h"
 #include "NavigationSystem.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
 
 EBTNodeResult::Type UBTTask_InterruptAttack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
+	COURSE_AI_PROFILE_SCOPE("InterruptAttack");
+
 	ACourseAIController* Controller = Cast<ACourseAIController>(OwnerComp.GetOwner());
 
 	if (Controller != nullptr)
@@ -0,0 +1,385 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseActorPoolSubsystem.h"
+#include "CourseNavObstacleSubsystem.h"
+#include "../UECourse.h"
+#include "../Items/PickUp.h"
+#include "../Items/PickUpSpawner.h"
+#include "EngineUtils.h"
+#include "NavRelevantComponent.h"
+#include "TimerManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Actor Pool Acquire"), STAT_ActorPoolAcquire, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Pool Spawns"), STAT_ActorPoolSpawns, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Actor Pool Free"), STAT_ActorPoolFree, STATGROUP_UECourse);
+
+/** Spawn rate and actor lifetime of the spawn benchmark, so about a hundred actors are alive at once. */
+static constexpr float BenchmarkSpawnInterval = 1.f / 50.f;
+static constexpr double BenchmarkLifetime = 2.0;
+
+static FAutoConsoleCommandWithWorldAndArgs CmdPoolBenchmark(
+	TEXT("course.Pool.Benchmark"),
+	TEXT("Spawns 50 actors per second for N seconds, pooled or with SpawnActor/Destroy, and logs spawn cost and GC hitches. Usage: course.Pool.Benchmark 20 1 [/Game/Path/BP_Class.BP_Class_C]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCourseActorPoolSubsystem* ActorPool = World ? World->GetSubsystem<UCourseActorPoolSubsystem>() : nullptr;
+
+		if (ActorPool == nullptr)
+		{
+			return;
+		}
+
+		const float Duration = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 20.f;
+		const bool bPooled = Args.Num() > 1 ? FCString::Atoi(*Args[1]) != 0 : true;
+		UClass* ActorClass = Args.Num() > 2 ? LoadClass<AActor>(nullptr, *Args[2]) : nullptr;
+
+		// Default to the pickup blueprint spawned in the level, so the numbers include its components
+		if (ActorClass == nullptr)
+		{
+			TActorIterator<APickUpSpawner> It(World);
+			ActorClass = It && It->GetItemClass() != nullptr ? It->GetItemClass().Get() : APickUp::StaticClass();
+		}
+
+		ActorPool->StartSpawnBenchmark(ActorClass, Duration, bPooled);
+	}));
+
+bool UCourseActorPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseActorPoolSubsystem::Deinitialize()
+{
+	if (Benchmark.IsValid())
+	{
+		FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(Benchmark->PreGCHandle);
+		FCoreUObjectDelegates::GetPostGarbageCollect().Remove(Benchmark->PostGCHandle);
+		Benchmark.Reset();
+	}
+
+	DEC_DWORD_STAT_BY(STAT_ActorPoolFree, NumFree);
+	NumFree = 0;
+	Pool.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCourseActorPoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (ActorClass == nullptr)
+	{
+		return;
+	}
+
+	for (int32 i = GetNumFree(ActorClass); i < Count; i++)
+	{
+		AActor* Actor = SpawnPooledActor(ActorClass, FTransform::Identity, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+		if (Actor == nullptr)
+		{
+			break;
+		}
+
+		ReleaseActor(Actor);
+	}
+}
+
+AActor* UCourseActorPoolSubsystem::AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, ESpawnActorCollisionHandlingMethod CollisionHandling)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ActorPoolAcquire);
+
+	if (ActorClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	TArray<TWeakObjectPtr<AActor>>* Free = Pool.Find(ActorClass);
+
+	while (Free != nullptr && Free->Num() > 0)
+	{
+		AActor* Actor = Free->Last().Get();
+
+		if (Actor == nullptr || Actor->IsPendingKill())
+		{
+			Free->Pop(false);
+			DEC_DWORD_STAT(STAT_ActorPoolFree);
+			NumFree--;
+			continue;
+		}
+
+		// Same placement rules as SpawnActor, tested with the actor's own collision
+		FVector Location = Transform.GetLocation();
+		const FRotator Rotation = Transform.Rotator();
+		const ESpawnActorCollisionHandlingMethod Method = CollisionHandling == ESpawnActorCollisionHandlingMethod::Undefined
+			? Actor->SpawnCollisionHandlingMethod : CollisionHandling;
+
+		Actor->SetActorEnableCollision(true);
+
+		bool bPlaced = true;
+		switch (Method)
+		{
+		case ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn:
+			GetWorld()->FindTeleportSpot(Actor, Location, Rotation);
+			break;
+		case ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding:
+			bPlaced = GetWorld()->FindTeleportSpot(Actor, Location, Rotation);
+			break;
+		case ESpawnActorCollisionHandlingMethod::DontSpawnIfColliding:
+			bPlaced = !GetWorld()->EncroachingBlockingGeometry(Actor, Location, Rotation);
+			break;
+		default:
+			break;
+		}
+
+		if (!bPlaced)
+		{
+			// The location is blocked, not the actor, so it stays in the pool
+			Actor->SetActorEnableCollision(false);
+			return nullptr;
+		}
+
+		Free->Pop(false);
+		DEC_DWORD_STAT(STAT_ActorPoolFree);
+		NumFree--;
+
+		Actor->SetActorTransform(FTransform(Rotation, Location, Transform.GetScale3D()), false, nullptr, ETeleportType::ResetPhysics);
+		Activate(Actor);
+
+		return Actor;
+	}
+
+	return SpawnPooledActor(ActorClass, Transform, CollisionHandling);
+}
+
+void UCourseActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	if (Actor == nullptr || Actor->IsPendingKill())
+	{
+		return;
+	}
+
+	TArray<TWeakObjectPtr<AActor>>& Free = Pool.FindOrAdd(Actor->GetClass());
+
+	if (Free.Contains(Actor))
+	{
+		return;
+	}
+
+	Deactivate(Actor);
+	Free.Add(Actor);
+	INC_DWORD_STAT(STAT_ActorPoolFree);
+	NumFree++;
+}
+
+void UCourseActorPoolSubsystem::ReleaseOrDestroy(AActor* Actor)
+{
+	if (Actor == nullptr)
+	{
+		return;
+	}
+
+	if (UCourseActorPoolSubsystem* ActorPool = UWorld::GetSubsystem<UCourseActorPoolSubsystem>(Actor->GetWorld()))
+	{
+		ActorPool->ReleaseActor(Actor);
+	}
+	else
+	{
+		Actor->Destroy();
+	}
+}
+
+int32 UCourseActorPoolSubsystem::GetNumFree(TSubclassOf<AActor> ActorClass) const
+{
+	const TArray<TWeakObjectPtr<AActor>>* Free = Pool.Find(ActorClass);
+	return Free != nullptr ? Free->Num() : 0;
+}
+
+AActor* UCourseActorPoolSubsystem::SpawnPooledActor(UClass* ActorClass, const FTransform& Transform, ESpawnActorCollisionHandlingMethod CollisionHandling)
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = CollisionHandling;
+
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParameters);
+
+	if (Actor != nullptr)
+	{
+		INC_DWORD_STAT(STAT_ActorPoolSpawns);
+	}
+
+	return Actor;
+}
+
+void UCourseActorPoolSubsystem::Deactivate(AActor* Actor)
+{
+	// Taken while the actor still collides, the bounds only count colliding components
+	TInlineComponentArray<UNavRelevantComponent*> NavComponents(Actor);
+	const FBox NavBounds = NavComponents.Num() > 0 ? Actor->GetComponentsBoundingBox() : FBox(ForceInit);
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+
+	// Nav modifiers would keep cutting the navmesh where the actor was released
+	for (UNavRelevantComponent* NavComponent : NavComponents)
+	{
+		NavComponent->SetNavigationRelevancy(false);
+	}
+
+	if (NavComponents.Num() > 0)
+	{
+		MarkNavDirty(Actor, NavBounds);
+	}
+}
+
+void UCourseActorPoolSubsystem::Activate(AActor* Actor)
+{
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+	// Bounds are cached, so they are recalculated at the new location
+	TInlineComponentArray<UNavRelevantComponent*> NavComponents(Actor);
+	for (UNavRelevantComponent* NavComponent : NavComponents)
+	{
+		NavComponent->SetNavigationRelevancy(true);
+		NavComponent->RefreshNavigationModifiers();
+	}
+
+	if (NavComponents.Num() > 0)
+	{
+		MarkNavDirty(Actor, Actor->GetComponentsBoundingBox());
+	}
+}
+
+void UCourseActorPoolSubsystem::MarkNavDirty(AActor* Actor, const FBox& Bounds)
+{
+	// Flow fields cache walkability, so they hear about obstacles the pool switches on or off
+	UCourseNavObstacleSubsystem* NavObstacles = GetWorld()->GetSubsystem<UCourseNavObstacleSubsystem>();
+
+	if (NavObstacles != nullptr && Actor->HasAuthority())
+	{
+		NavObstacles->MarkDirty(Bounds);
+	}
+}
+
+void UCourseActorPoolSubsystem::StartSpawnBenchmark(TSubclassOf<AActor> ActorClass, float Duration, bool bPooled)
+{
+	if (ActorClass == nullptr || Benchmark.IsValid())
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	APlayerController* PlayerController = World->GetFirstPlayerController();
+	APawn* Player = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+	Benchmark = MakeUnique<FSpawnBenchmark>();
+	Benchmark->ActorClass = ActorClass.Get();
+	Benchmark->bPooled = bPooled;
+	Benchmark->EndTime = World->GetTimeSeconds() + Duration;
+	Benchmark->Center = Player ? Player->GetActorLocation() + Player->GetActorForwardVector() * 1500.f : FVector::ZeroVector;
+	Benchmark->Stream.Initialize(TEXT("PoolBenchmark"));
+
+	if (bPooled)
+	{
+		Prewarm(ActorClass, FMath::CeilToInt(BenchmarkLifetime / BenchmarkSpawnInterval) + 1);
+	}
+
+	Benchmark->PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddWeakLambda(this, [this]()
+	{
+		Benchmark->GCStart = FPlatformTime::Seconds();
+	});
+
+	Benchmark->PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddWeakLambda(this, [this]()
+	{
+		const double Seconds = FPlatformTime::Seconds() - Benchmark->GCStart;
+		Benchmark->Collections++;
+		Benchmark->GCSeconds += Seconds;
+		Benchmark->MaxGCSeconds = FMath::Max(Benchmark->MaxGCSeconds, Seconds);
+
+		// The collection forced at the end picks up whatever the run left behind
+		if (Benchmark->bFinished)
+		{
+			FinishSpawnBenchmark();
+		}
+	});
+
+	World->GetTimerManager().SetTimer(Benchmark->Timer, FTimerDelegate::CreateUObject(this, &UCourseActorPoolSubsystem::TickSpawnBenchmark), BenchmarkSpawnInterval, true);
+
+	UE_LOG(LogTemp, Warning, TEXT("Pool benchmark: spawning %s at 50/s for %.0f s, %s"),
+		*ActorClass->GetName(), Duration, bPooled ? TEXT("pooled") : TEXT("SpawnActor/Destroy"));
+}
+
+void UCourseActorPoolSubsystem::TickSpawnBenchmark()
+{
+	UWorld* World = GetWorld();
+	const double Now = World->GetTimeSeconds();
+
+	// Remove the oldest actors the same way the game would, released or destroyed
+	while (Benchmark->Live.Num() > 0 && (Now - Benchmark->Live[0].Value >= BenchmarkLifetime || Now >= Benchmark->EndTime))
+	{
+		if (AActor* Actor = Benchmark->Live[0].Key.Get())
+		{
+			if (Benchmark->bPooled)
+			{
+				ReleaseActor(Actor);
+			}
+			else
+			{
+				Actor->Destroy();
+			}
+		}
+
+		Benchmark->Live.RemoveAt(0, 1, false);
+	}
+
+	if (Now >= Benchmark->EndTime)
+	{
+		World->GetTimerManager().ClearTimer(Benchmark->Timer);
+		Benchmark->bFinished = true;
+		GEngine->ForceGarbageCollection(true);
+		return;
+	}
+
+	UClass* ActorClass = Benchmark->ActorClass.Get();
+
+	if (ActorClass == nullptr)
+	{
+		return;
+	}
+
+	const FVector Location = Benchmark->Center + FVector(Benchmark->Stream.FRandRange(-1000.f, 1000.f), Benchmark->Stream.FRandRange(-1000.f, 1000.f), 0.f);
+	const FTransform Transform(Location);
+
+	const double Start = FPlatformTime::Seconds();
+	AActor* Actor = Benchmark->bPooled
+		? AcquireActor(ActorClass, Transform, ESpawnActorCollisionHandlingMethod::AlwaysSpawn)
+		: SpawnPooledActor(ActorClass, Transform, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	const double Seconds = FPlatformTime::Seconds() - Start;
+
+	if (Actor != nullptr)
+	{
+		Benchmark->Spawns++;
+		Benchmark->SpawnSeconds += Seconds;
+		Benchmark->MaxSpawnSeconds = FMath::Max(Benchmark->MaxSpawnSeconds, Seconds);
+		Benchmark->Live.Emplace(Actor, Now);
+	}
+}
+
+void UCourseActorPoolSubsystem::FinishSpawnBenchmark()
+{
+	UE_LOG(LogTemp, Warning, TEXT("Pool benchmark (%s): %d spawns, avg %.3f ms max %.3f ms; %d GCs, avg %.2f ms max %.2f ms"),
+		Benchmark->bPooled ? TEXT("pooled") : TEXT("SpawnActor/Destroy"),
+		Benchmark->Spawns,
+		Benchmark->Spawns > 0 ? Benchmark->SpawnSeconds / Benchmark->Spawns * 1000.0 : 0.0,
+		Benchmark->MaxSpawnSeconds * 1000.0,
+		Benchmark->Collections,
+		Benchmark->Collections > 0 ? Benchmark->GCSeconds / Benchmark->Collections * 1000.0 : 0.0,
+		Benchmark->MaxGCSeconds * 1000.0);
+
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(Benchmark->PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(Benchmark->PostGCHandle);
+	Benchmark.Reset();
+}
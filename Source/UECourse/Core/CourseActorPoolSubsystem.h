@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "CourseActorPoolSubsystem.generated.h"
+
+/**
+ * World-level pool of actors keyed by class.
+ * Released actors are hidden, lose collision, tick and navigation relevancy, and are handed out again by AcquireActor
+ * instead of paying for SpawnActor, Destroy and the garbage collection that follows.
+ */
+UCLASS()
+class UECOURSE_API UCourseActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/** Spawns released actors of the class until at least Count are free. */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	/**
+	 * Returns a free actor moved to the transform, or spawns a new one when the pool is empty.
+	 * Returns null when the collision handling rejects the location, like SpawnActor does.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform,
+		ESpawnActorCollisionHandlingMethod CollisionHandling = ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+	/** Deactivates the actor and keeps it for the next AcquireActor of its class. */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	void ReleaseActor(AActor* Actor);
+
+	/** Releases the actor into its world's pool, or destroys it when there is none. */
+	static void ReleaseOrDestroy(AActor* Actor);
+
+	int32 GetNumFree(TSubclassOf<AActor> ActorClass) const;
+
+	/** Spawns and removes actors at a fixed rate and logs spawn cost and garbage collection time. */
+	void StartSpawnBenchmark(TSubclassOf<AActor> ActorClass, float Duration, bool bPooled);
+
+private:
+	TMap<UClass*, TArray<TWeakObjectPtr<AActor>>> Pool;
+
+	int32 NumFree = 0;
+
+	AActor* SpawnPooledActor(UClass* ActorClass, const FTransform& Transform, ESpawnActorCollisionHandlingMethod CollisionHandling);
+	void Deactivate(AActor* Actor);
+	void Activate(AActor* Actor);
+
+	/** Reports where a pooled actor's nav modifiers were switched on or off. */
+	void MarkNavDirty(AActor* Actor, const FBox& Bounds);
+
+	struct FSpawnBenchmark
+	{
+		TWeakObjectPtr<UClass> ActorClass;
+		bool bPooled = true;
+		bool bFinished = false;
+		double EndTime = 0.0;
+		FVector Center = FVector::ZeroVector;
+		FRandomStream Stream;
+		TArray<TPair<TWeakObjectPtr<AActor>, double>> Live;
+		FTimerHandle Timer;
+		FDelegateHandle PreGCHandle;
+		FDelegateHandle PostGCHandle;
+
+		int32 Spawns = 0;
+		double SpawnSeconds = 0.0;
+		double MaxSpawnSeconds = 0.0;
+		int32 Collections = 0;
+		double GCStart = 0.0;
+		double GCSeconds = 0.0;
+		double MaxGCSeconds = 0.0;
+	};
+
+	TUniquePtr<FSpawnBenchmark> Benchmark;
+
+	void TickSpawnBenchmark();
+	void FinishSpawnBenchmark();
+};
@@ -0,0 +1,376 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseActorRegistrySubsystem.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+
+static FAutoConsoleCommandWithWorldAndArgs CmdRegistryBenchmark(
+	TEXT("course.Registry.Benchmark"),
+	TEXT("Compares the actor registry with UGameplayStatics lookups at N extra actors. Usage: course.Registry.Benchmark 1000 10000 50000"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCourseActorRegistrySubsystem* Registry = World ? World->GetSubsystem<UCourseActorRegistrySubsystem>() : nullptr;
+
+		if (Registry == nullptr)
+		{
+			return;
+		}
+
+		TArray<int32> Counts;
+
+		for (const FString& Arg : Args)
+		{
+			Counts.Add(FCString::Atoi(*Arg));
+		}
+
+		if (Counts.Num() == 0)
+		{
+			Counts = { 1000, 10000, 50000 };
+		}
+
+		const FName Tag(TEXT("RegistryBenchmark"));
+		const int32 Iterations = 100;
+
+		for (int32 Count : Counts)
+		{
+			TArray<AActor*> Spawned;
+
+			for (int32 i = 0; i < Count; i++)
+			{
+				AActor* Actor = World->SpawnActor<AActor>();
+
+				// One in ten actors carries the tag, like a handful of gameplay markers in a large level
+				if (Actor != nullptr && i % 10 == 0)
+				{
+					Registry->AddActorTag(Actor, Tag);
+				}
+
+				Spawned.Add(Actor);
+			}
+
+			TArray<AActor*> Result;
+
+			double Start = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Iterations; i++)
+			{
+				Result.Reset();
+				UGameplayStatics::GetAllActorsWithTag(World, Tag, Result);
+			}
+			const double StaticsTag = (FPlatformTime::Seconds() - Start) / Iterations;
+
+			Start = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Iterations; i++)
+			{
+				Result.Reset();
+				Registry->GetAllActorsWithTag(Tag, Result);
+			}
+			const double RegistryTag = (FPlatformTime::Seconds() - Start) / Iterations;
+
+			Start = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Iterations; i++)
+			{
+				Result.Reset();
+				UGameplayStatics::GetAllActorsOfClassWithTag(World, AActor::StaticClass(), Tag, Result);
+			}
+			const double StaticsClassTag = (FPlatformTime::Seconds() - Start) / Iterations;
+
+			Start = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Iterations; i++)
+			{
+				Result.Reset();
+				Registry->GetAllActorsOfClassWithTag(AActor::StaticClass(), Tag, Result);
+			}
+			const double RegistryClassTag = (FPlatformTime::Seconds() - Start) / Iterations;
+
+			UE_LOG(LogTemp, Warning, TEXT("Registry benchmark %d actors: WithTag statics %.3f ms registry %.3f ms, OfClassWithTag statics %.3f ms registry %.3f ms"),
+				Count, StaticsTag * 1000.0, RegistryTag * 1000.0, StaticsClassTag * 1000.0, RegistryClassTag * 1000.0);
+
+			for (AActor* Actor : Spawned)
+			{
+				if (Actor != nullptr)
+				{
+					Actor->Destroy();
+				}
+			}
+		}
+	}));
+
+bool UCourseActorRegistrySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseActorRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	UWorld* World = GetWorld();
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UCourseActorRegistrySubsystem::HandleActorSpawned));
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UCourseActorRegistrySubsystem::HandleLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UCourseActorRegistrySubsystem::HandleLevelRemoved);
+}
+
+void UCourseActorRegistrySubsystem::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	ActorsByClass.Empty();
+	ActorsByTag.Empty();
+	IndexedTags.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCourseActorRegistrySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Actors loaded with the map never go through the spawn handler
+	for (ULevel* Level : InWorld.GetLevels())
+	{
+		HandleLevelAdded(Level, &InWorld);
+	}
+}
+
+bool UCourseActorRegistrySubsystem::IsLive(const AActor* Actor)
+{
+	return IsValid(Actor) && !Actor->IsPendingKillPending();
+}
+
+void UCourseActorRegistrySubsystem::AddActor(AActor* Actor)
+{
+	if (!IsLive(Actor) || IndexedTags.Contains(Actor))
+	{
+		return;
+	}
+
+	ActorsByClass.FindOrAdd(Actor->GetClass()).Add(Actor);
+	IndexedTags.Add(Actor);
+
+	for (const FName& Tag : Actor->Tags)
+	{
+		IndexTag(Actor, Tag);
+	}
+
+	Actor->OnDestroyed.AddUniqueDynamic(this, &UCourseActorRegistrySubsystem::HandleActorDestroyed);
+}
+
+void UCourseActorRegistrySubsystem::RemoveActor(AActor* Actor)
+{
+	TArray<FName> Tags;
+
+	if (!IndexedTags.RemoveAndCopyValue(Actor, Tags))
+	{
+		return;
+	}
+
+	for (const FName& Tag : Tags)
+	{
+		if (FActorSet* Set = ActorsByTag.Find(Tag))
+		{
+			Set->Remove(Actor);
+		}
+	}
+
+	if (FActorSet* Set = ActorsByClass.Find(Actor->GetClass()))
+	{
+		Set->Remove(Actor);
+	}
+
+	Actor->OnDestroyed.RemoveDynamic(this, &UCourseActorRegistrySubsystem::HandleActorDestroyed);
+}
+
+void UCourseActorRegistrySubsystem::IndexTag(AActor* Actor, FName Tag)
+{
+	TArray<FName>* Tags = IndexedTags.Find(Actor);
+
+	if (Tags != nullptr && !Tags->Contains(Tag))
+	{
+		Tags->Add(Tag);
+		ActorsByTag.FindOrAdd(Tag).Add(Actor);
+	}
+}
+
+void UCourseActorRegistrySubsystem::UnindexTag(AActor* Actor, FName Tag)
+{
+	TArray<FName>* Tags = IndexedTags.Find(Actor);
+
+	if (Tags != nullptr && Tags->Remove(Tag) > 0)
+	{
+		if (FActorSet* Set = ActorsByTag.Find(Tag))
+		{
+			Set->Remove(Actor);
+		}
+	}
+}
+
+void UCourseActorRegistrySubsystem::AddActorTag(AActor* Actor, FName Tag)
+{
+	if (Actor != nullptr)
+	{
+		Actor->Tags.AddUnique(Tag);
+		IndexTag(Actor, Tag);
+	}
+}
+
+void UCourseActorRegistrySubsystem::RemoveActorTag(AActor* Actor, FName Tag)
+{
+	if (Actor != nullptr)
+	{
+		Actor->Tags.Remove(Tag);
+		UnindexTag(Actor, Tag);
+	}
+}
+
+void UCourseActorRegistrySubsystem::RefreshActorTags(AActor* Actor)
+{
+	const TArray<FName>* Tags = IndexedTags.Find(Actor);
+
+	if (Tags == nullptr)
+	{
+		return;
+	}
+
+	const TArray<FName> OldTags = *Tags;
+
+	for (const FName& Tag : OldTags)
+	{
+		if (!Actor->Tags.Contains(Tag))
+		{
+			UnindexTag(Actor, Tag);
+		}
+	}
+
+	for (const FName& Tag : Actor->Tags)
+	{
+		IndexTag(Actor, Tag);
+	}
+}
+
+void UCourseActorRegistrySubsystem::HandleActorSpawned(AActor* Actor)
+{
+	AddActor(Actor);
+}
+
+void UCourseActorRegistrySubsystem::HandleActorDestroyed(AActor* Actor)
+{
+	RemoveActor(Actor);
+}
+
+void UCourseActorRegistrySubsystem::HandleLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (Level == nullptr || World != GetWorld())
+	{
+		return;
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		AddActor(Actor);
+	}
+}
+
+void UCourseActorRegistrySubsystem::HandleLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (Level == nullptr || World != GetWorld())
+	{
+		return;
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor != nullptr)
+		{
+			RemoveActor(Actor);
+		}
+	}
+}
+
+void UCourseActorRegistrySubsystem::ForEachActorOfClass(UClass* ActorClass, TFunctionRef<bool(AActor*)> Func) const
+{
+	if (ActorClass == nullptr)
+	{
+		return;
+	}
+
+	for (const TPair<UClass*, FActorSet>& Pair : ActorsByClass)
+	{
+		if (!Pair.Key->IsChildOf(ActorClass))
+		{
+			continue;
+		}
+
+		for (const TWeakObjectPtr<AActor>& WeakActor : Pair.Value)
+		{
+			AActor* Actor = WeakActor.Get();
+
+			if (IsLive(Actor) && !Func(Actor))
+			{
+				return;
+			}
+		}
+	}
+}
+
+void UCourseActorRegistrySubsystem::GetAllActorsOfClass(TSubclassOf<AActor> ActorClass, TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset();
+	ForEachActorOfClass(ActorClass, [&OutActors](AActor* Actor) { OutActors.Add(Actor); return true; });
+}
+
+AActor* UCourseActorRegistrySubsystem::GetActorOfClass(TSubclassOf<AActor> ActorClass) const
+{
+	AActor* Result = nullptr;
+	ForEachActorOfClass(ActorClass, [&Result](AActor* Actor) { Result = Actor; return false; });
+	return Result;
+}
+
+void UCourseActorRegistrySubsystem::GetAllActorsOfClassWithTag(TSubclassOf<AActor> ActorClass, FName Tag, TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset();
+
+	if (ActorClass == nullptr)
+	{
+		return;
+	}
+
+	if (const FActorSet* Set = ActorsByTag.Find(Tag))
+	{
+		for (const TWeakObjectPtr<AActor>& WeakActor : *Set)
+		{
+			AActor* Actor = WeakActor.Get();
+
+			if (IsLive(Actor) && Actor->IsA(ActorClass))
+			{
+				OutActors.Add(Actor);
+			}
+		}
+	}
+}
+
+void UCourseActorRegistrySubsystem::GetAllActorsWithTag(FName Tag, TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset();
+
+	if (const FActorSet* Set = ActorsByTag.Find(Tag))
+	{
+		for (const TWeakObjectPtr<AActor>& WeakActor : *Set)
+		{
+			AActor* Actor = WeakActor.Get();
+
+			if (IsLive(Actor))
+			{
+				OutActors.Add(Actor);
+			}
+		}
+	}
+}
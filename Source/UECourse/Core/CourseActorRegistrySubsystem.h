@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CourseActorRegistrySubsystem.generated.h"
+
+/**
+ * Class and tag indices over the actors of a world, kept up to date on spawn, destroy and level streaming.
+ * Queries cost O(result) instead of walking every actor in the world.
+ * Tags changed through AddActorTag/RemoveActorTag are indexed right away, RefreshActorTags picks up direct edits of AActor::Tags.
+ */
+UCLASS()
+class UECOURSE_API UCourseActorRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	UFUNCTION(BlueprintCallable, Category = "Actor Registry", meta = (DeterminesOutputType = "ActorClass", DynamicOutputParam = "OutActors"))
+	void GetAllActorsOfClass(TSubclassOf<AActor> ActorClass, TArray<AActor*>& OutActors) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Actor Registry", meta = (DeterminesOutputType = "ActorClass"))
+	AActor* GetActorOfClass(TSubclassOf<AActor> ActorClass) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Actor Registry", meta = (DeterminesOutputType = "ActorClass", DynamicOutputParam = "OutActors"))
+	void GetAllActorsOfClassWithTag(TSubclassOf<AActor> ActorClass, FName Tag, TArray<AActor*>& OutActors) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Actor Registry")
+	void GetAllActorsWithTag(FName Tag, TArray<AActor*>& OutActors) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Actor Registry")
+	void AddActorTag(AActor* Actor, FName Tag);
+
+	UFUNCTION(BlueprintCallable, Category = "Actor Registry")
+	void RemoveActorTag(AActor* Actor, FName Tag);
+
+	UFUNCTION(BlueprintCallable, Category = "Actor Registry")
+	void RefreshActorTags(AActor* Actor);
+
+	template<typename T>
+	void GetActorsOfClass(TArray<T*>& OutActors) const
+	{
+		ForEachActorOfClass(T::StaticClass(), [&OutActors](AActor* Actor) { OutActors.Add(static_cast<T*>(Actor)); return true; });
+	}
+
+	/** Calls Func for every live actor of the class or its subclasses, stops when Func returns false. */
+	void ForEachActorOfClass(UClass* ActorClass, TFunctionRef<bool(AActor*)> Func) const;
+
+private:
+	typedef TSet<TWeakObjectPtr<AActor>> FActorSet;
+
+	TMap<UClass*, FActorSet> ActorsByClass;
+	TMap<FName, FActorSet> ActorsByTag;
+
+	/** Tags each actor was indexed under, so removal does not depend on the current AActor::Tags. */
+	TMap<TWeakObjectPtr<AActor>, TArray<FName>> IndexedTags;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+	void AddActor(AActor* Actor);
+	void RemoveActor(AActor* Actor);
+	void IndexTag(AActor* Actor, FName Tag);
+	void UnindexTag(AActor* Actor, FName Tag);
+
+	void HandleActorSpawned(AActor* Actor);
+	void HandleLevelAdded(ULevel* Level, UWorld* World);
+	void HandleLevelRemoved(ULevel* Level, UWorld* World);
+
+	UFUNCTION()
+	void HandleActorDestroyed(AActor* Actor);
+
+	static bool IsLive(const AActor* Actor);
+};
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseCombatState.h"
+
+bool FCourseCombatState::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	uint8 Flags = (bAttack ? 1 : 0) | (bStunned ? 2 : 0) | (bUseControllerRotationYaw ? 4 : 0);
+	Ar.SerializeBits(&Flags, 3);
+
+	bAttack = (Flags & 1) != 0;
+	bStunned = (Flags & 2) != 0;
+	bUseControllerRotationYaw = (Flags & 4) != 0;
+
+	if (bStunned)
+	{
+		Ar << StunStartServerTime;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CourseCombatState.generated.h"
+
+/**
+ * Attack and stun state of a fighter, replicated as a single property.
+ * Clients derive the remaining stun time from StunStartServerTime instead of waiting for a finish event.
+ */
+USTRUCT(BlueprintType)
+struct UECOURSE_API FCourseCombatState
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bAttack = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bStunned = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bUseControllerRotationYaw = false;
+
+	/** Server world time at which the current stun started, only valid while stunned. */
+	UPROPERTY(BlueprintReadOnly)
+	float StunStartServerTime = 0.f;
+
+	bool operator==(const FCourseCombatState& Other) const
+	{
+		return bAttack == Other.bAttack
+			&& bStunned == Other.bStunned
+			&& bUseControllerRotationYaw == Other.bUseControllerRotationYaw
+			&& (!bStunned || StunStartServerTime == Other.StunStartServerTime);
+	}
+
+	bool operator!=(const FCourseCombatState& Other) const { return !(*this == Other); }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FCourseCombatState> : public TStructOpsTypeTraitsBase2<FCourseCombatState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseDamageSubsystem.h"
+#include "../UECourse.h"
+#include "../FighterInterface.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Resolve"), STAT_DamageResolve, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Events"), STAT_DamageEvents, STATGROUP_UECourse);
+
+bool UCourseDamageSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseDamageSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCourseDamageSubsystem::HandlePostActorTick);
+}
+
+void UCourseDamageSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	PendingEvents.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCourseDamageSubsystem::QueueDamage(AActor* Target, int32 Damage)
+{
+	if (Cast<IFighterInterface>(Target) != nullptr)
+	{
+		PendingEvents.Add({ Target, Damage });
+	}
+}
+
+void UCourseDamageSubsystem::ApplyDamage(AActor* Target, int32 Damage)
+{
+	if (Target == nullptr)
+	{
+		return;
+	}
+
+	if (UCourseDamageSubsystem* Subsystem = UWorld::GetSubsystem<UCourseDamageSubsystem>(Target->GetWorld()))
+	{
+		Subsystem->QueueDamage(Target, Damage);
+	}
+	else if (IFighterInterface* Fighter = Cast<IFighterInterface>(Target))
+	{
+		const bool bWasAlive = Fighter->IsAlive();
+		Fighter->TakeDamage(Damage);
+		Fighter->OnDamageResolved(Damage, bWasAlive && !Fighter->IsAlive());
+	}
+}
+
+void UCourseDamageSubsystem::HandlePostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld())
+	{
+		ResolveDamage();
+	}
+}
+
+void UCourseDamageSubsystem::ResolveDamage()
+{
+	if (PendingEvents.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DamageResolve);
+	INC_DWORD_STAT_BY(STAT_DamageEvents, PendingEvents.Num());
+
+	// Apply every hit in queue order, only HP changes here
+	for (const FPendingDamage& Event : PendingEvents)
+	{
+		AActor* Target = Event.Target.Get();
+		IFighterInterface* Fighter = Cast<IFighterInterface>(Target);
+
+		if (Fighter == nullptr)
+		{
+			continue;
+		}
+
+		int32* Index = ResolvedIndices.Find(Target);
+
+		if (Index == nullptr)
+		{
+			Index = &ResolvedIndices.Add(Target, ResolvedFighters.Num());
+			ResolvedFighters.Add({ Target, 0, Fighter->IsAlive() });
+		}
+
+		ResolvedFighters[*Index].TotalDamage += Event.Damage;
+		Fighter->TakeDamage(Event.Damage);
+	}
+
+	// Swap the queue out first, dispatching may queue damage for the next frame
+	TArray<FResolvedFighter> Resolved = MoveTemp(ResolvedFighters);
+	PendingEvents.Reset();
+	ResolvedFighters.Reset();
+	ResolvedIndices.Reset();
+
+	for (const FResolvedFighter& Entry : Resolved)
+	{
+		if (IFighterInterface* Fighter = Cast<IFighterInterface>(Entry.Target.Get()))
+		{
+			Fighter->OnDamageResolved(Entry.TotalDamage, Entry.bWasAlive && !Fighter->IsAlive());
+		}
+	}
+
+	// Keep the allocation for the next frame
+	Resolved.Reset();
+	ResolvedFighters = MoveTemp(Resolved);
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CourseDamageSubsystem.generated.h"
+
+class IFighterInterface;
+
+/**
+ * Collects the hits of a frame and resolves them together once all actors have ticked.
+ * Hits are applied in the order they were queued, then every fighter that was hit gets a single UI and death update.
+ */
+UCLASS()
+class UECOURSE_API UCourseDamageSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Target must implement IFighterInterface. */
+	UFUNCTION(BlueprintCallable)
+	void QueueDamage(AActor* Target, int32 Damage);
+
+	/** Queues the hit in the target's world, or applies it right away outside of game worlds. */
+	static void ApplyDamage(AActor* Target, int32 Damage);
+
+	void ResolveDamage();
+
+private:
+	struct FPendingDamage
+	{
+		TWeakObjectPtr<AActor> Target;
+		int32 Damage = 0;
+	};
+
+	struct FResolvedFighter
+	{
+		TWeakObjectPtr<AActor> Target;
+		int32 TotalDamage = 0;
+		bool bWasAlive = false;
+	};
+
+	TArray<FPendingDamage> PendingEvents;
+	TArray<FResolvedFighter> ResolvedFighters;
+	TMap<AActor*, int32> ResolvedIndices;
+
+	FDelegateHandle PostActorTickHandle;
+
+	void HandlePostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+};
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseInputPacket.h"
+
+int8 FCourseInputFrame::QuantizeAxis(float Value, float Range)
+{
+	return (int8)FMath::Clamp(FMath::RoundToInt(Value / Range * 127.f), -127, 127);
+}
+
+float FCourseInputFrame::DequantizeAxis(int8 Value, float Range)
+{
+	return Value / 127.f * Range;
+}
+
+void FCourseInputBundle::Push(const FCourseInputFrame& Frame, uint16 Sequence)
+{
+	for (int32 i = MaxFrames - 1; i > 0; i--)
+	{
+		Frames[i] = Frames[i - 1];
+	}
+
+	Frames[0] = Frame;
+	LatestSequence = Sequence;
+	NumFrames = FMath::Min<uint8>(NumFrames + 1, MaxFrames);
+}
+
+bool FCourseInputBundle::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << LatestSequence;
+
+	uint32 Count = NumFrames;
+	Ar.SerializeInt(Count, MaxFrames + 1);
+	NumFrames = (uint8)FMath::Min<uint32>(Count, MaxFrames);
+
+	for (int32 i = 0; i < NumFrames; i++)
+	{
+		FCourseInputFrame& Frame = Frames[i];
+		Ar << Frame.Forward;
+		Ar << Frame.Right;
+		Ar << Frame.Turn;
+
+		uint8 AttackBit = Frame.bAttack ? 1 : 0;
+		Ar.SerializeBits(&AttackBit, 1);
+		Frame.bAttack = AttackBit != 0;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+bool FCourseAnimInputs::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Forward;
+	Ar << Right;
+	Ar << Turn;
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
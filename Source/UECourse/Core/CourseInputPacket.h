@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CourseInputPacket.generated.h"
+
+/** One tick of player input, quantized to a byte per axis. */
+USTRUCT()
+struct UECOURSE_API FCourseInputFrame
+{
+	GENERATED_BODY()
+
+	static constexpr float MoveAxisRange = 1.f;
+	static constexpr float TurnAxisRange = 4.f;
+
+	int8 Forward = 0;
+	int8 Right = 0;
+	int8 Turn = 0;
+	bool bAttack = false;
+
+	static int8 QuantizeAxis(float Value, float Range);
+	static float DequantizeAxis(int8 Value, float Range);
+
+	bool HasSameInput(const FCourseInputFrame& Other) const
+	{
+		return Forward == Other.Forward && Right == Other.Right && Turn == Other.Turn && bAttack == Other.bAttack;
+	}
+};
+
+/**
+ * Unreliable input packet sent from the owning client to the server.
+ * Carries the newest input frame plus the previous ones, so a lost packet is recovered by the next one.
+ * Frames are stored newest first and have consecutive sequence numbers ending at LatestSequence.
+ */
+USTRUCT()
+struct UECOURSE_API FCourseInputBundle
+{
+	GENERATED_BODY()
+
+	static constexpr int32 MaxFrames = 3;
+
+	uint16 LatestSequence = 0;
+	uint8 NumFrames = 0;
+	FCourseInputFrame Frames[MaxFrames];
+
+	void Push(const FCourseInputFrame& Frame, uint16 Sequence);
+
+	uint16 GetSequence(int32 Index) const { return LatestSequence - Index; }
+
+	/** Wrap-around aware sequence comparison. */
+	static bool IsNewerSequence(uint16 A, uint16 B) { return (int16)(A - B) > 0; }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+/** Animation inputs replicated to simulated proxies, one byte per axis. */
+USTRUCT()
+struct UECOURSE_API FCourseAnimInputs
+{
+	GENERATED_BODY()
+
+	int8 Forward = 0;
+	int8 Right = 0;
+	int8 Turn = 0;
+
+	bool operator==(const FCourseAnimInputs& Other) const
+	{
+		return Forward == Other.Forward && Right == Other.Right && Turn == Other.Turn;
+	}
+
+	bool operator!=(const FCourseAnimInputs& Other) const { return !(*this == Other); }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FCourseInputBundle> : public TStructOpsTypeTraitsBase2<FCourseInputBundle>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+template<>
+struct TStructOpsTypeTraits<FCourseAnimInputs> : public TStructOpsTypeTraitsBase2<FCourseAnimInputs>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseNavObstacleSubsystem.h"
+#include "../UECourse.h"
+#include "NavigationSystem.h"
+#include "NavModifierComponent.h"
+#include "NavAreas/NavArea_Null.h"
+
+DECLARE_CYCLE_STAT(TEXT("Nav Obstacle Register"), STAT_NavObstacleRegister, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Nav Obstacles Pending"), STAT_NavObstaclesPending, STATGROUP_UECourse);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Nav Rebuild Latency (ms)"), STAT_NavRebuildLatency, STATGROUP_UECourse);
+
+static int32 NavObstaclesPerFrame = 8;
+static FAutoConsoleVariableRef CVarNavObstaclesPerFrame(
+	TEXT("course.Nav.ObstaclesPerFrame"),
+	NavObstaclesPerFrame,
+	TEXT("Nav modifiers registered per frame, the rest wait for the next frames."));
+
+bool UCourseNavObstacleSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseNavObstacleSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &UCourseNavObstacleSubsystem::HandleNavigationGenerationFinished);
+	}
+}
+
+void UCourseNavObstacleSubsystem::RegisterObstacle(AActor* Actor)
+{
+	// Navigation only exists on the server
+	if (Actor != nullptr && Actor->HasAuthority())
+	{
+		PendingObstacles.Add(Actor);
+		INC_DWORD_STAT(STAT_NavObstaclesPending);
+	}
+}
+
+void UCourseNavObstacleSubsystem::MarkDirty(const FBox& Bounds)
+{
+	if (!Bounds.IsValid)
+	{
+		return;
+	}
+
+	if (OldestDirtyTime < 0.0)
+	{
+		OldestDirtyTime = FPlatformTime::Seconds();
+	}
+
+	NumDirtyObstacles++;
+	DirtyBounds.Add(Bounds);
+}
+
+TStatId UCourseNavObstacleSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseNavObstacleSubsystem, STATGROUP_Tickables);
+}
+
+void UCourseNavObstacleSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NavObstacleRegister);
+
+	const int32 Count = FMath::Min(PendingObstacles.Num(), FMath::Max(NavObstaclesPerFrame, 1));
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		AActor* Actor = PendingObstacles[i].Get();
+
+		if (Actor == nullptr || Actor->IsPendingKill())
+		{
+			continue;
+		}
+
+		// A pooled actor comes back with the modifier it was given the first time
+		if (Actor->FindComponentByClass<UNavModifierComponent>() == nullptr)
+		{
+			// The modifier takes its bounds from the actor's colliding components and unregisters with the actor
+			UNavModifierComponent* Modifier = NewObject<UNavModifierComponent>(Actor);
+			Modifier->SetAreaClass(UNavArea_Null::StaticClass());
+			Modifier->RegisterComponent();
+		}
+
+		MarkDirty(Actor->GetComponentsBoundingBox());
+	}
+
+	PendingObstacles.RemoveAt(0, Count, false);
+	DEC_DWORD_STAT_BY(STAT_NavObstaclesPending, Count);
+}
+
+void UCourseNavObstacleSubsystem::HandleNavigationGenerationFinished(ANavigationData* NavData)
+{
+	if (OldestDirtyTime < 0.0)
+	{
+		return;
+	}
+
+	// From the oldest modifier to the moment no tile is left to build
+	const double Latency = (FPlatformTime::Seconds() - OldestDirtyTime) * 1000.0;
+	SET_FLOAT_STAT(STAT_NavRebuildLatency, Latency);
+	UE_LOG(LogTemp, Log, TEXT("Navmesh rebuilt for %d obstacles, %.1f ms after the oldest one was added"), NumDirtyObstacles, Latency);
+
+	OldestDirtyTime = -1.0;
+	NumDirtyObstacles = 0;
+
+	// Swapped out first, so obstacles added by a listener wait for the next rebuild
+	const TArray<FBox> BuiltBounds = MoveTemp(DirtyBounds);
+	DirtyBounds.Reset();
+	OnObstaclesBuilt.Broadcast(BuiltBounds);
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CourseNavObstacleSubsystem.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FCourseOnNavObstaclesBuilt, const TArray<FBox>& /*DirtyBounds*/);
+
+/**
+ * Cuts spawned obstacles out of the navmesh with nav modifiers.
+ * With RuntimeGeneration=DynamicModifiersOnly only the tiles under a modifier are rebuilt, on worker threads.
+ * Registrations are spread over frames so a burst of spawns is coalesced into few dirty area flushes.
+ */
+UCLASS()
+class UECOURSE_API UCourseNavObstacleSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Queues a nav modifier for the actor's collision bounds. */
+	UFUNCTION(BlueprintCallable, Category = "Navigation")
+	void RegisterObstacle(AActor* Actor);
+
+	/** Reports bounds whose nav modifiers were switched on or off, so they reach the next OnObstaclesBuilt. Server only. */
+	void MarkDirty(const FBox& Bounds);
+
+	/** Called once the navmesh under the obstacles added since the last call is rebuilt, with their bounds. */
+	FCourseOnNavObstaclesBuilt OnObstaclesBuilt;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return PendingObstacles.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	TArray<TWeakObjectPtr<AActor>> PendingObstacles;
+
+	/** Time the oldest modifier not yet covered by a finished rebuild was added, negative when none. */
+	double OldestDirtyTime = -1.0;
+	int32 NumDirtyObstacles = 0;
+
+	/** Bounds of the modifiers not yet covered by a finished rebuild. */
+	TArray<FBox> DirtyBounds;
+
+	UFUNCTION()
+	void HandleNavigationGenerationFinished(class ANavigationData* NavData);
+};
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseRewindSubsystem.h"
+#include "../UECourse.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Rewind Record"), STAT_RewindRecord, STATGROUP_UECourse);
+DECLARE_CYCLE_STAT(TEXT("Rewind Sweep"), STAT_RewindSweep, STATGROUP_UECourse);
+
+bool UCourseRewindSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseRewindSubsystem::RegisterFighter(ACharacter* Fighter)
+{
+	if (Fighter != nullptr && FindHistory(Fighter) == nullptr)
+	{
+		FHistory& History = Histories.AddDefaulted_GetRef();
+		History.Fighter = Fighter;
+	}
+}
+
+void UCourseRewindSubsystem::UnregisterFighter(ACharacter* Fighter)
+{
+	Histories.RemoveAllSwap([Fighter](const FHistory& History) { return History.Fighter == Fighter; });
+}
+
+const UCourseRewindSubsystem::FHistory* UCourseRewindSubsystem::FindHistory(const ACharacter* Fighter) const
+{
+	return Histories.FindByPredicate([Fighter](const FHistory& History) { return History.Fighter == Fighter; });
+}
+
+bool UCourseRewindSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->GetNetMode() != NM_Client && Histories.Num() > 0;
+}
+
+TStatId UCourseRewindSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseRewindSubsystem, STATGROUP_Tickables);
+}
+
+void UCourseRewindSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RewindRecord);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	for (FHistory& History : Histories)
+	{
+		const ACharacter* Fighter = History.Fighter.Get();
+
+		if (Fighter == nullptr)
+		{
+			continue;
+		}
+
+		const UCapsuleComponent* Capsule = Fighter->GetCapsuleComponent();
+
+		History.Head = (History.Head + 1) % HistorySize;
+		History.Num = FMath::Min(History.Num + 1, HistorySize);
+
+		FCourseRewindSample& Sample = History.Samples[History.Head];
+		Sample.Time = Now;
+		Sample.Location = Capsule->GetComponentLocation();
+		Sample.Rotation = Capsule->GetComponentQuat();
+		Sample.Radius = Capsule->GetScaledCapsuleRadius();
+		Sample.HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+	}
+}
+
+bool UCourseRewindSubsystem::GetSampleAtTime(const ACharacter* Fighter, float Time, FCourseRewindSample& OutSample) const
+{
+	const FHistory* History = FindHistory(Fighter);
+	return History != nullptr && SampleHistory(*History, Time, OutSample);
+}
+
+bool UCourseRewindSubsystem::SampleHistory(const FHistory& History, float Time, FCourseRewindSample& OutSample) const
+{
+	if (History.Num == 0)
+	{
+		return false;
+	}
+
+	// Walk back from the newest sample until the requested time is bracketed
+	for (int32 Age = 0; Age < History.Num; Age++)
+	{
+		const FCourseRewindSample& Older = History.Get(Age);
+
+		if (Older.Time > Time)
+		{
+			continue;
+		}
+
+		if (Age == 0)
+		{
+			OutSample = Older;
+			return true;
+		}
+
+		const FCourseRewindSample& Newer = History.Get(Age - 1);
+		const float Alpha = (Time - Older.Time) / FMath::Max(Newer.Time - Older.Time, KINDA_SMALL_NUMBER);
+
+		OutSample.Time = Time;
+		OutSample.Location = FMath::Lerp(Older.Location, Newer.Location, Alpha);
+		OutSample.Rotation = FQuat::Slerp(Older.Rotation, Newer.Rotation, Alpha);
+		OutSample.Radius = Newer.Radius;
+		OutSample.HalfHeight = Newer.HalfHeight;
+		return true;
+	}
+
+	OutSample = History.Get(History.Num - 1);
+	return true;
+}
+
+void UCourseRewindSubsystem::SweepFighters(const ACharacter* Attacker, const FVector& Start, const FVector& End, float Radius, float Time, TArray<ACharacter*>& OutHits) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_RewindSweep);
+
+	for (const FHistory& History : Histories)
+	{
+		ACharacter* Fighter = History.Fighter.Get();
+
+		if (Fighter == nullptr || Fighter == Attacker)
+		{
+			continue;
+		}
+
+		FCourseRewindSample Sample;
+
+		if (!SampleHistory(History, Time, Sample))
+		{
+			continue;
+		}
+
+		// A capsule is a segment with a radius, so the sweep hits when the two segments come closer than both radii
+		const FVector Axis = Sample.Rotation.GetUpVector() * FMath::Max(Sample.HalfHeight - Sample.Radius, 0.f);
+		FVector SweepPoint;
+		FVector CapsulePoint;
+		FMath::SegmentDistToSegmentSafe(Start, End, Sample.Location - Axis, Sample.Location + Axis, SweepPoint, CapsulePoint);
+
+		if (FVector::DistSquared(SweepPoint, CapsulePoint) <= FMath::Square(Radius + Sample.Radius))
+		{
+			OutHits.Add(Fighter);
+		}
+	}
+}
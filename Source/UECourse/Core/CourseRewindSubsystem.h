@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CourseRewindSubsystem.generated.h"
+
+/** Capsule of a fighter at one server frame. */
+struct FCourseRewindSample
+{
+	float Time = 0.f;
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	float Radius = 0.f;
+	float HalfHeight = 0.f;
+};
+
+/**
+ * Server-side history of fighter capsules, used to validate hits at the time the attacker saw them.
+ */
+UCLASS()
+class UECOURSE_API UCourseRewindSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Number of server frames kept per fighter. */
+	static constexpr int32 HistorySize = 64;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	void RegisterFighter(ACharacter* Fighter);
+	void UnregisterFighter(ACharacter* Fighter);
+
+	/** Interpolated capsule of the fighter at the given server time, clamped to the recorded history. */
+	bool GetSampleAtTime(const ACharacter* Fighter, float Time, FCourseRewindSample& OutSample) const;
+
+	/**
+	 * Sweeps a sphere from Start to End against every fighter rewound to Time.
+	 * Returns the fighters that were hit, the attacker is skipped.
+	 */
+	void SweepFighters(const ACharacter* Attacker, const FVector& Start, const FVector& End, float Radius, float Time, TArray<ACharacter*>& OutHits) const;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FHistory
+	{
+		TWeakObjectPtr<ACharacter> Fighter;
+		FCourseRewindSample Samples[HistorySize];
+		int32 Head = 0;
+		int32 Num = 0;
+
+		const FCourseRewindSample& Get(int32 Age) const { return Samples[(Head - Age + HistorySize) % HistorySize]; }
+	};
+
+	TArray<FHistory> Histories;
+
+	const FHistory* FindHistory(const ACharacter* Fighter) const;
+
+	bool SampleHistory(const FHistory& History, float Time, FCourseRewindSample& OutSample) const;
+};
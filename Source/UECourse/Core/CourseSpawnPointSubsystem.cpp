@@ -0,0 +1,317 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseSpawnPointSubsystem.h"
+#include "../UECourse.h"
+#include "Components/BoxComponent.h"
+#include "NavigationSystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Point Build"), STAT_SpawnPointBuild, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spawn Points Free"), STAT_SpawnPointsFree, STATGROUP_UECourse);
+
+static int32 SpawnPointProjectionsPerFrame = 32;
+static FAutoConsoleVariableRef CVarSpawnPointProjectionsPerFrame(
+	TEXT("course.Spawn.ProjectionsPerFrame"),
+	SpawnPointProjectionsPerFrame,
+	TEXT("Spawn point candidates projected to the navmesh and sent for an async overlap test per frame."));
+
+/** Upper bound of points per volume. */
+static constexpr int32 MaxSpawnPoints = 256;
+
+/** Samples tried around an active point before it is retired, as in Bridson's algorithm. */
+static constexpr int32 PoissonAttempts = 30;
+
+bool UCourseSpawnPointSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseSpawnPointSubsystem::Deinitialize()
+{
+	for (const TPair<int32, FSpawnPointSet>& Pair : Sets)
+	{
+		DEC_DWORD_STAT_BY(STAT_SpawnPointsFree, Pair.Value.FreePoints.Num());
+	}
+
+	Sets.Empty();
+	NumBuilding = 0;
+
+	Super::Deinitialize();
+}
+
+TStatId UCourseSpawnPointSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseSpawnPointSubsystem, STATGROUP_Tickables);
+}
+
+int32 UCourseSpawnPointSubsystem::RegisterVolume(UBoxComponent* Volume, float MinDistance, float Clearance)
+{
+	if (Volume == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	if (Sets.Num() == 0)
+	{
+		Random.GenerateNewSeed();
+	}
+
+	const int32 SetId = NextSetId++;
+	FSpawnPointSet& Set = Sets.Add(SetId);
+	Set.Volume = Volume;
+	Set.Clearance = Clearance;
+
+	GenerateCandidates(Set, MinDistance);
+	NumBuilding++;
+
+	return SetId;
+}
+
+void UCourseSpawnPointSubsystem::UnregisterVolume(int32 SetId)
+{
+	if (FSpawnPointSet* Set = Sets.Find(SetId))
+	{
+		if (!Set->bReady)
+		{
+			NumBuilding--;
+		}
+
+		DEC_DWORD_STAT_BY(STAT_SpawnPointsFree, Set->FreePoints.Num());
+		Sets.Remove(SetId);
+	}
+}
+
+bool UCourseSpawnPointSubsystem::IsReady(int32 SetId) const
+{
+	const FSpawnPointSet* Set = Sets.Find(SetId);
+	return Set != nullptr && Set->bReady;
+}
+
+bool UCourseSpawnPointSubsystem::AcquirePoint(int32 SetId, FVector& OutLocation, int32& OutPoint)
+{
+	FSpawnPointSet* Set = Sets.Find(SetId);
+
+	if (Set == nullptr || !Set->bReady || Set->FreePoints.Num() == 0)
+	{
+		return false;
+	}
+
+	const int32 FreeIndex = Random.RandHelper(Set->FreePoints.Num());
+	OutPoint = Set->FreePoints[FreeIndex];
+	OutLocation = Set->Points[OutPoint];
+
+	Set->FreePoints.RemoveAtSwap(FreeIndex, 1, false);
+	Set->Occupied[OutPoint] = true;
+	DEC_DWORD_STAT(STAT_SpawnPointsFree);
+
+	return true;
+}
+
+void UCourseSpawnPointSubsystem::ReleasePoint(int32 SetId, int32 Point)
+{
+	FSpawnPointSet* Set = Sets.Find(SetId);
+
+	if (Set != nullptr && Set->Occupied.IsValidIndex(Point) && Set->Occupied[Point])
+	{
+		Set->Occupied[Point] = false;
+		Set->FreePoints.Add(Point);
+		INC_DWORD_STAT(STAT_SpawnPointsFree);
+	}
+}
+
+int32 UCourseSpawnPointSubsystem::GetNumFree(int32 SetId) const
+{
+	const FSpawnPointSet* Set = Sets.Find(SetId);
+	return Set != nullptr ? Set->FreePoints.Num() : 0;
+}
+
+void UCourseSpawnPointSubsystem::GenerateCandidates(FSpawnPointSet& Set, float MinDistance)
+{
+	const UBoxComponent* Volume = Set.Volume.Get();
+	const FVector Center = Volume->GetComponentLocation();
+	const FVector Extent = Volume->GetScaledBoxExtent();
+	const FVector2D Size(Extent.X * 2.f, Extent.Y * 2.f);
+
+	// Keep the background grid small for tiny distances in large volumes
+	MinDistance = FMath::Max3(MinDistance, Size.GetMax() / 512.f, 1.f);
+
+	const float CellSize = MinDistance / FMath::Sqrt(2.f);
+	const int32 GridWidth = FMath::CeilToInt(Size.X / CellSize) + 1;
+	const int32 GridHeight = FMath::CeilToInt(Size.Y / CellSize) + 1;
+
+	TArray<int32> Grid;
+	Grid.Init(INDEX_NONE, GridWidth * GridHeight);
+
+	TArray<FVector2D> Samples;
+	TArray<int32> ActiveSamples;
+
+	auto GetCell = [CellSize](const FVector2D& Sample)
+	{
+		return FIntPoint(FMath::FloorToInt(Sample.X / CellSize), FMath::FloorToInt(Sample.Y / CellSize));
+	};
+
+	auto AddSample = [&](const FVector2D& Sample)
+	{
+		const FIntPoint Cell = GetCell(Sample);
+		Grid[Cell.Y * GridWidth + Cell.X] = Samples.Num();
+		ActiveSamples.Add(Samples.Num());
+		Samples.Add(Sample);
+	};
+
+	auto IsFarEnough = [&](const FVector2D& Sample)
+	{
+		const FIntPoint Cell = GetCell(Sample);
+
+		for (int32 Y = FMath::Max(Cell.Y - 2, 0); Y <= FMath::Min(Cell.Y + 2, GridHeight - 1); Y++)
+		{
+			for (int32 X = FMath::Max(Cell.X - 2, 0); X <= FMath::Min(Cell.X + 2, GridWidth - 1); X++)
+			{
+				const int32 Other = Grid[Y * GridWidth + X];
+
+				if (Other != INDEX_NONE && FVector2D::DistSquared(Samples[Other], Sample) < FMath::Square(MinDistance))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	};
+
+	AddSample(FVector2D(Random.FRandRange(0.f, Size.X), Random.FRandRange(0.f, Size.Y)));
+
+	while (ActiveSamples.Num() > 0 && Samples.Num() < MaxSpawnPoints)
+	{
+		const int32 ActiveIndex = Random.RandHelper(ActiveSamples.Num());
+		const FVector2D Origin = Samples[ActiveSamples[ActiveIndex]];
+		bool bAdded = false;
+
+		for (int32 Attempt = 0; Attempt < PoissonAttempts; Attempt++)
+		{
+			const float Angle = Random.FRandRange(0.f, 2.f * PI);
+			const float Distance = Random.FRandRange(MinDistance, 2.f * MinDistance);
+			const FVector2D Sample = Origin + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Distance;
+
+			if (Sample.X >= 0.f && Sample.Y >= 0.f && Sample.X < Size.X && Sample.Y < Size.Y && IsFarEnough(Sample))
+			{
+				AddSample(Sample);
+				bAdded = true;
+				break;
+			}
+		}
+
+		if (!bAdded)
+		{
+			ActiveSamples.RemoveAtSwap(ActiveIndex, 1, false);
+		}
+	}
+
+	// Points keep the height of the volume, like the random points the spawner used before
+	const FVector Corner = Center - FVector(Extent.X, Extent.Y, 0.f);
+	Set.Candidates.Reserve(Samples.Num());
+
+	for (const FVector2D& Sample : Samples)
+	{
+		Set.Candidates.Add(Corner + FVector(Sample.X, Sample.Y, 0.f));
+	}
+}
+
+void UCourseSpawnPointSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnPointBuild);
+
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent<UNavigationSystemV1>(World);
+	int32 Budget = FMath::Max(SpawnPointProjectionsPerFrame, 1);
+
+	for (TPair<int32, FSpawnPointSet>& Pair : Sets)
+	{
+		FSpawnPointSet& Set = Pair.Value;
+
+		while (!Set.bReady && Set.NextCandidate < Set.Candidates.Num() && Budget > 0)
+		{
+			FVector Location = Set.Candidates[Set.NextCandidate++];
+			FVector TestLocation = Location;
+			Budget--;
+
+			// Navigation only exists on the server, clients keep the unprojected point
+			if (NavSys != nullptr)
+			{
+				FNavLocation NavLocation;
+				const FVector QueryExtent(Set.Clearance, Set.Clearance, Set.Volume.IsValid() ? Set.Volume->GetScaledBoxExtent().Z + 200.f : 500.f);
+
+				if (!NavSys->ProjectPointToNavigation(Location, NavLocation, QueryExtent))
+				{
+					continue;
+				}
+
+				Location.X = NavLocation.Location.X;
+				Location.Y = NavLocation.Location.Y;
+
+				// The clearance sphere rests on the floor, the volume's height may be within reach of it
+				TestLocation = NavLocation.Location + FVector(0.f, 0.f, Set.Clearance);
+			}
+
+			// Pickups and spawned items are tracked by occupancy, only static geometry can block a point
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SpawnPointOverlap), false, Set.Volume.IsValid() ? Set.Volume->GetOwner() : nullptr);
+			World->AsyncOverlapByObjectType(TestLocation, FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllStaticObjects),
+				FCollisionShape::MakeSphere(Set.Clearance), QueryParams,
+				FOverlapDelegate::CreateUObject(this, &UCourseSpawnPointSubsystem::HandleOverlap, Pair.Key, Location));
+			Set.PendingOverlaps++;
+		}
+
+		FinishIfDone(Set);
+	}
+}
+
+void UCourseSpawnPointSubsystem::HandleOverlap(const FTraceHandle& Handle, FOverlapDatum& Datum, int32 SetId, FVector Location)
+{
+	FSpawnPointSet* Set = Sets.Find(SetId);
+
+	if (Set == nullptr)
+	{
+		return;
+	}
+
+	Set->PendingOverlaps--;
+
+	if (Datum.OutOverlaps.Num() == 0)
+	{
+		Set->Points.Add(Location);
+	}
+
+	FinishIfDone(*Set);
+}
+
+void UCourseSpawnPointSubsystem::FinishIfDone(FSpawnPointSet& Set)
+{
+	if (Set.bReady || Set.NextCandidate < Set.Candidates.Num() || Set.PendingOverlaps > 0)
+	{
+		return;
+	}
+
+	Set.bReady = true;
+
+	// Unchecked points would break the promise of clear, navmesh-projected points, so the level has to be fixed instead
+	if (Set.Points.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("None of the %d spawn points of %s passed the navmesh and clearance tests, nothing will spawn there"),
+			Set.Candidates.Num(), Set.Volume.IsValid() ? *Set.Volume->GetOwner()->GetName() : TEXT("<removed>"));
+	}
+
+	Set.Candidates.Empty();
+	Set.Occupied.Init(false, Set.Points.Num());
+	Set.FreePoints.Reserve(Set.Points.Num());
+
+	for (int32 i = 0; i < Set.Points.Num(); i++)
+	{
+		Set.FreePoints.Add(i);
+	}
+
+	INC_DWORD_STAT_BY(STAT_SpawnPointsFree, Set.FreePoints.Num());
+	NumBuilding--;
+
+	UE_LOG(LogTemp, Log, TEXT("Spawn point set of %s ready with %d points"),
+		Set.Volume.IsValid() ? *Set.Volume->GetOwner()->GetName() : TEXT("<removed>"), Set.Points.Num());
+}
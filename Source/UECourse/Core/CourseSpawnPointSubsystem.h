@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "CourseSpawnPointSubsystem.generated.h"
+
+class UBoxComponent;
+
+/**
+ * Precomputes collision-free spawn points per spawn volume.
+ * Points are Poisson-disk distributed over the volume, projected to the navmesh and checked with async overlaps,
+ * so handing one out later never runs a collision query. Occupied points are tracked in a bitmap and the free ones
+ * in a list, a random free point is taken and returned in constant time.
+ */
+UCLASS()
+class UECOURSE_API UCourseSpawnPointSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Starts building the point set of a volume, points are at least MinDistance apart and Clearance away from static geometry.
+	 * Returns an id for the other functions.
+	 */
+	int32 RegisterVolume(UBoxComponent* Volume, float MinDistance, float Clearance);
+
+	void UnregisterVolume(int32 SetId);
+
+	/** True once every candidate of the set has been tested. */
+	bool IsReady(int32 SetId) const;
+
+	/** Marks a random free point as occupied. Returns false while the set is building or when every point is taken. */
+	bool AcquirePoint(int32 SetId, FVector& OutLocation, int32& OutPoint);
+
+	void ReleasePoint(int32 SetId, int32 Point);
+
+	int32 GetNumFree(int32 SetId) const;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return NumBuilding > 0; }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FSpawnPointSet
+	{
+		TWeakObjectPtr<UBoxComponent> Volume;
+		float Clearance = 0.f;
+
+		/** Poisson-disk samples still waiting for navmesh projection. */
+		TArray<FVector> Candidates;
+		int32 NextCandidate = 0;
+		int32 PendingOverlaps = 0;
+		bool bReady = false;
+
+		TArray<FVector> Points;
+		TBitArray<> Occupied;
+		TArray<int32> FreePoints;
+	};
+
+	TMap<int32, FSpawnPointSet> Sets;
+	FRandomStream Random;
+	int32 NextSetId = 1;
+	int32 NumBuilding = 0;
+
+	void GenerateCandidates(FSpawnPointSet& Set, float MinDistance);
+	void HandleOverlap(const FTraceHandle& Handle, FOverlapDatum& Datum, int32 SetId, FVector Location);
+	void FinishIfDone(FSpawnPointSet& Set);
+};
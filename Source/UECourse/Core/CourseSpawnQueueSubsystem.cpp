@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseSpawnQueueSubsystem.h"
+#include "../UECourse.h"
+#include "CourseActorPoolSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Queue"), STAT_SpawnQueue, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spawn Queue Depth"), STAT_SpawnQueueDepth, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawn Queue Steps"), STAT_SpawnQueueSteps, STATGROUP_UECourse);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Spawn Queue ms"), STAT_SpawnQueueMs, STATGROUP_UECourse);
+
+static float SpawnBudgetMs = 1.f;
+static FAutoConsoleVariableRef CVarSpawnBudgetMs(
+	TEXT("course.Spawn.BudgetMs"),
+	SpawnBudgetMs,
+	TEXT("Game thread milliseconds per frame spent on queued spawns. At least one step runs every frame."));
+
+static int32 SpawnMaxPerFrame = 4;
+static FAutoConsoleVariableRef CVarSpawnMaxPerFrame(
+	TEXT("course.Spawn.MaxPerFrame"),
+	SpawnMaxPerFrame,
+	TEXT("Queued spawn steps per frame. Pool acquires and deferred creation or finishing each count as one step."));
+
+bool UCourseSpawnQueueSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseSpawnQueueSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_SpawnQueueDepth, GetQueueDepth());
+
+	for (TArray<FRequest>& Queue : Queues)
+	{
+		Queue.Empty();
+	}
+
+	Finishing.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCourseSpawnQueueSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseSpawnQueueSubsystem, STATGROUP_Tickables);
+}
+
+int32 UCourseSpawnQueueSubsystem::EnqueueSpawn(TSubclassOf<AActor> ActorClass, const FTransform& Transform, ECourseSpawnPriority Priority, FCourseOnSpawned Callback,
+	ESpawnActorCollisionHandlingMethod CollisionHandling)
+{
+	FRequest& Request = Queues[FMath::Clamp((int32)Priority, 0, NumPriorities - 1)].AddDefaulted_GetRef();
+	Request.Id = NextRequestId++;
+	Request.ActorClass = ActorClass;
+	Request.Transform = Transform;
+	Request.CollisionHandling = CollisionHandling;
+	Request.Callback = MoveTemp(Callback);
+
+	INC_DWORD_STAT(STAT_SpawnQueueDepth);
+
+	return Request.Id;
+}
+
+void UCourseSpawnQueueSubsystem::CancelSpawn(int32 RequestId)
+{
+	for (TArray<FRequest>& Queue : Queues)
+	{
+		const int32 Index = Queue.IndexOfByPredicate([RequestId](const FRequest& Request) { return Request.Id == RequestId; });
+
+		if (Index != INDEX_NONE)
+		{
+			Queue.RemoveAt(Index);
+			DEC_DWORD_STAT(STAT_SpawnQueueDepth);
+			return;
+		}
+	}
+
+	// Already created, finish it so the actor ends up in the pool instead of half constructed
+	for (FRequest& Request : Finishing)
+	{
+		if (Request.Id == RequestId)
+		{
+			Request.Callback.Unbind();
+			return;
+		}
+	}
+}
+
+int32 UCourseSpawnQueueSubsystem::GetQueueDepth() const
+{
+	int32 Depth = Finishing.Num();
+
+	for (const TArray<FRequest>& Queue : Queues)
+	{
+		Depth += Queue.Num();
+	}
+
+	return Depth;
+}
+
+void UCourseSpawnQueueSubsystem::Tick(float DeltaTime)
+{
+	ProcessQueue(SpawnBudgetMs * 0.001, SpawnMaxPerFrame);
+}
+
+void UCourseSpawnQueueSubsystem::ProcessQueue(double BudgetSeconds, int32 MaxSteps)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnQueue);
+
+	const double Start = FPlatformTime::Seconds();
+	int32 Steps = 0;
+
+	while (GetQueueDepth() > 0 && (Steps == 0 || (Steps < MaxSteps && FPlatformTime::Seconds() - Start < BudgetSeconds)))
+	{
+		RunStep();
+		Steps++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_SpawnQueueSteps, Steps);
+	INC_FLOAT_STAT_BY(STAT_SpawnQueueMs, (float)((FPlatformTime::Seconds() - Start) * 1000.0));
+}
+
+void UCourseSpawnQueueSubsystem::RunStep()
+{
+	if (Finishing.Num() > 0)
+	{
+		// Callbacks can queue new spawns, so the request is taken out before it runs
+		FRequest Request = MoveTemp(Finishing[0]);
+		Finishing.RemoveAt(0, 1, false);
+		DEC_DWORD_STAT(STAT_SpawnQueueDepth);
+
+		AActor* Actor = Request.Deferred.Get();
+
+		if (Actor != nullptr && !Actor->IsPendingKill())
+		{
+			Actor->FinishSpawning(Request.Transform);
+		}
+
+		Complete(Request, Actor != nullptr && !Actor->IsPendingKill() ? Actor : nullptr);
+		return;
+	}
+
+	for (TArray<FRequest>& Queue : Queues)
+	{
+		if (Queue.Num() == 0)
+		{
+			continue;
+		}
+
+		FRequest Request = MoveTemp(Queue[0]);
+		Queue.RemoveAt(0, 1, false);
+
+		UCourseActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UCourseActorPoolSubsystem>();
+
+		if (Request.ActorClass == nullptr)
+		{
+			DEC_DWORD_STAT(STAT_SpawnQueueDepth);
+			Complete(Request, nullptr);
+		}
+		else if (ActorPool != nullptr && ActorPool->GetNumFree(Request.ActorClass) > 0)
+		{
+			DEC_DWORD_STAT(STAT_SpawnQueueDepth);
+			Complete(Request, ActorPool->AcquireActor(Request.ActorClass, Request.Transform, Request.CollisionHandling));
+		}
+		else
+		{
+			AActor* Actor = GetWorld()->SpawnActorDeferred<AActor>(Request.ActorClass, Request.Transform, nullptr, nullptr, Request.CollisionHandling);
+
+			if (Actor != nullptr)
+			{
+				Request.Deferred = Actor;
+				Finishing.Add(MoveTemp(Request));
+			}
+			else
+			{
+				DEC_DWORD_STAT(STAT_SpawnQueueDepth);
+				Complete(Request, nullptr);
+			}
+		}
+
+		return;
+	}
+}
+
+void UCourseSpawnQueueSubsystem::Complete(FRequest& Request, AActor* Actor)
+{
+	if (!Request.Callback.ExecuteIfBound(Actor) && Actor != nullptr)
+	{
+		// Nobody is waiting for the actor any more
+		UCourseActorPoolSubsystem::ReleaseOrDestroy(Actor);
+	}
+}
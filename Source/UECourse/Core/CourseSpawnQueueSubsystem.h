@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Engine/EngineTypes.h"
+#include "CourseSpawnQueueSubsystem.generated.h"
+
+DECLARE_DELEGATE_OneParam(FCourseOnSpawned, AActor* /*Actor*/);
+
+UENUM(BlueprintType)
+enum class ECourseSpawnPriority : uint8
+{
+	High,
+	Normal,
+	Low
+};
+
+/**
+ * Spreads spawns over frames under a per-frame time and count budget.
+ * Requests come out by priority, oldest first. A free actor from the actor pool is used when there is one,
+ * otherwise the actor is created with SpawnActorDeferred and finished on a later step, so construction scripts
+ * and BeginPlay of a new actor do not land in the same step as its creation.
+ */
+UCLASS()
+class UECOURSE_API UCourseSpawnQueueSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Queues a spawn, Callback is called from a later tick with the actor or null when it could not be placed.
+	 * Actors whose callback is no longer bound go back to the actor pool. Returns an id for CancelSpawn.
+	 */
+	int32 EnqueueSpawn(TSubclassOf<AActor> ActorClass, const FTransform& Transform, ECourseSpawnPriority Priority, FCourseOnSpawned Callback,
+		ESpawnActorCollisionHandlingMethod CollisionHandling = ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+	void CancelSpawn(int32 RequestId);
+
+	/** Runs queued spawn steps until the budget or the count is spent. */
+	void ProcessQueue(double BudgetSeconds, int32 MaxSteps);
+
+	int32 GetQueueDepth() const;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return GetQueueDepth() > 0; }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FRequest
+	{
+		int32 Id = 0;
+		TSubclassOf<AActor> ActorClass;
+		FTransform Transform;
+		ESpawnActorCollisionHandlingMethod CollisionHandling = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		FCourseOnSpawned Callback;
+
+		/** Created with SpawnActorDeferred and waiting for FinishSpawning. */
+		TWeakObjectPtr<AActor> Deferred;
+	};
+
+	static constexpr int32 NumPriorities = 3;
+
+	TArray<FRequest> Queues[NumPriorities];
+
+	/** Deferred actors come first, their creation has already been paid for. */
+	TArray<FRequest> Finishing;
+
+	int32 NextRequestId = 1;
+
+	void RunStep();
+	void Complete(FRequest& Request, AActor* Actor);
+};
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseTimeOfDaySubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "TimerManager.h"
+
+float UCourseTimeOfDaySubsystem::GetServerTime() const
+{
+	const UWorld* World = GetWorld();
+	const AGameStateBase* GameState = World->GetGameState();
+
+	return GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+float UCourseTimeOfDaySubsystem::GetHour() const
+{
+	return FMath::Clamp(StartHour + (GetServerTime() - StartServerTime) * HoursPerSecond, 0.f, 24.f);
+}
+
+void UCourseTimeOfDaySubsystem::SetClock(float InStartServerTime, float InStartHour, float InHoursPerSecond)
+{
+	StartServerTime = InStartServerTime;
+	StartHour = InStartHour;
+	HoursPerSecond = InHoursPerSecond;
+
+	// Announce the starting hour as well
+	CurrentHour = INDEX_NONE;
+	HandleHourBoundary();
+}
+
+void UCourseTimeOfDaySubsystem::HandleHourBoundary()
+{
+	const float Hour = GetHour();
+	const int32 NewHour = FMath::FloorToInt(Hour);
+
+	if (NewHour != CurrentHour)
+	{
+		CurrentHour = NewHour;
+		OnHourChanged.Broadcast(CurrentHour);
+	}
+
+	ScheduleNextHour();
+}
+
+void UCourseTimeOfDaySubsystem::ScheduleNextHour()
+{
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	TimerManager.ClearTimer(HourTimerHandle);
+
+	if (HoursPerSecond <= 0.f || CurrentHour >= 24)
+	{
+		return;
+	}
+
+	// Local and server time drift apart slightly, an early wake up just reschedules for the rest of the hour
+	const float SecondsToNextHour = (CurrentHour + 1 - GetHour()) / HoursPerSecond;
+	TimerManager.SetTimer(HourTimerHandle, this, &UCourseTimeOfDaySubsystem::HandleHourBoundary, FMath::Max(SecondsToNextHour, 0.01f), false);
+}
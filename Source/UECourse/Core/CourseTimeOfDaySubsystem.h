@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CourseTimeOfDaySubsystem.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FCourseOnHourChanged, int32 /*Hour*/);
+
+/**
+ * Game time of the world, computed from the server time the clock was started at instead of being ticked.
+ * Clients compute the same hour from the synchronized server time, OnHourChanged fires only when an hour boundary is crossed.
+ */
+UCLASS()
+class UECOURSE_API UCourseTimeOfDaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Hour of the day the game clock is at, from 0 to 24. */
+	UFUNCTION(BlueprintPure, Category = "Time Of Day")
+	float GetHour() const;
+
+	/** Starts the clock at StartHour at the given server time, advancing HoursPerSecond and stopping at 24. */
+	void SetClock(float InStartServerTime, float InStartHour, float InHoursPerSecond);
+
+	FCourseOnHourChanged OnHourChanged;
+
+private:
+	float StartServerTime = 0.f;
+	float StartHour = 0.f;
+	float HoursPerSecond = 0.f;
+	int32 CurrentHour = 0;
+
+	FTimerHandle HourTimerHandle;
+
+	float GetServerTime() const;
+	void ScheduleNextHour();
+	void HandleHourBoundary();
+};
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseTransitionSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/PackageName.h"
+#include "UObject/UObjectGlobals.h"
+
+void UCourseTransitionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UCourseTransitionSubsystem::OnPostLoadMap);
+
+	if (GEngine != nullptr)
+	{
+		TravelFailureHandle = GEngine->OnTravelFailure().AddUObject(this, &UCourseTransitionSubsystem::OnTravelFailure);
+		NetworkFailureHandle = GEngine->OnNetworkFailure().AddUObject(this, &UCourseTransitionSubsystem::OnNetworkFailure);
+	}
+}
+
+void UCourseTransitionSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	FTicker::GetCoreTicker().RemoveTicker(ProgressTickerHandle);
+
+	if (GEngine != nullptr)
+	{
+		GEngine->OnTravelFailure().Remove(TravelFailureHandle);
+		GEngine->OnNetworkFailure().Remove(NetworkFailureHandle);
+	}
+
+	Super::Deinitialize();
+}
+
+void UCourseTransitionSubsystem::TravelToLevel(FName LevelName)
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+
+	if (World == nullptr || IsTransitionInProgress())
+	{
+		return;
+	}
+
+	PendingLevelName = LevelName;
+	RequestTime = FPlatformTime::Seconds();
+
+	const FString MapName = LevelName.ToString() + FPackageName::GetMapPackageExtension();
+	const bool bFound = FPackageName::SearchForPackageOnDisk(MapName, &PendingPackageName);
+
+	if (World->GetNetMode() == NM_ListenServer || World->GetNetMode() == NM_DedicatedServer)
+	{
+		// Seamless travel loads the destination in the background behind the transition map and keeps clients connected
+		SwitchTime = RequestTime;
+
+		if (!World->ServerTravel(LevelName.ToString(), false))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Server travel to %s failed to start"), *LevelName.ToString());
+			ResetTransition();
+		}
+		return;
+	}
+
+	if (!bFound)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Level %s not found, opening it without preload"), *LevelName.ToString());
+		FinishTransition();
+		return;
+	}
+
+	ProgressTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UCourseTransitionSubsystem::TickProgress));
+	LoadPackageAsync(PendingPackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &UCourseTransitionSubsystem::OnPackageLoaded));
+}
+
+bool UCourseTransitionSubsystem::TickProgress(float DeltaTime)
+{
+	const float Progress = GetAsyncLoadPercentage(FName(*PendingPackageName));
+
+	if (Progress >= 0.f)
+	{
+		OnTransitionProgressEvent.Broadcast(Progress);
+	}
+
+	return true;
+}
+
+void UCourseTransitionSubsystem::OnPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+	FTicker::GetCoreTicker().RemoveTicker(ProgressTickerHandle);
+	ProgressTickerHandle.Reset();
+
+	if (Result == EAsyncLoadingResult::Succeeded)
+	{
+		PreloadedWorld = UWorld::FindWorldInPackage(LoadedPackage);
+		OnTransitionProgressEvent.Broadcast(100.f);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Preloaded %s in %.1f ms"), *PackageName.ToString(), (FPlatformTime::Seconds() - RequestTime) * 1000.0);
+
+	FinishTransition();
+}
+
+void UCourseTransitionSubsystem::FinishTransition()
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+
+	if (World == nullptr)
+	{
+		ResetTransition();
+		return;
+	}
+
+	// The package is already in memory, so the map switch only has to initialize the world
+	SwitchTime = FPlatformTime::Seconds();
+	UGameplayStatics::OpenLevel(World, PendingLevelName);
+}
+
+void UCourseTransitionSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (!IsTransitionInProgress() || LoadedWorld == nullptr)
+	{
+		return;
+	}
+
+	// Seamless travel loads the transition map first, only the destination finishes the transition
+	if (!PendingPackageName.IsEmpty() && UWorld::RemovePIEPrefix(LoadedWorld->GetOutermost()->GetName()) != PendingPackageName)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	UE_LOG(LogTemp, Log, TEXT("Transition to %s: %.1f ms blocking map switch, %.1f ms total"),
+		*PendingLevelName.ToString(), (Now - SwitchTime) * 1000.0, (Now - RequestTime) * 1000.0);
+
+	ResetTransition();
+}
+
+void UCourseTransitionSubsystem::OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType, const FString& ErrorString)
+{
+	if (IsTransitionInProgress())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Transition to %s failed: %s"), *PendingLevelName.ToString(), *ErrorString);
+		ResetTransition();
+	}
+}
+
+void UCourseTransitionSubsystem::OnNetworkFailure(UWorld* World, UNetDriver* NetDriver, ENetworkFailure::Type FailureType, const FString& ErrorString)
+{
+	if (IsTransitionInProgress())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Transition to %s interrupted by a network failure: %s"), *PendingLevelName.ToString(), *ErrorString);
+		ResetTransition();
+	}
+}
+
+void UCourseTransitionSubsystem::ResetTransition()
+{
+	FTicker::GetCoreTicker().RemoveTicker(ProgressTickerHandle);
+	ProgressTickerHandle.Reset();
+
+	PendingLevelName = NAME_None;
+	PendingPackageName.Reset();
+	PreloadedWorld = nullptr;
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Engine/EngineBaseTypes.h"
+#include "CourseTransitionSubsystem.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCSOnTransitionProgress, float, Progress);
+
+/**
+ * Level transitions without a blocking map load.
+ * Standalone and client worlds preload the map package in the background and switch once it is in memory,
+ * servers use seamless travel through the transition map so connected clients stay connected.
+ */
+UCLASS()
+class UECOURSE_API UCourseTransitionSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	UFUNCTION(BlueprintCallable)
+	void TravelToLevel(FName LevelName);
+
+	UFUNCTION(BlueprintPure)
+	bool IsTransitionInProgress() const { return !PendingLevelName.IsNone(); }
+
+	/** Preload progress from 0 to 100. */
+	UPROPERTY(BlueprintAssignable)
+	FCSOnTransitionProgress OnTransitionProgressEvent;
+
+private:
+	FName PendingLevelName;
+	FString PendingPackageName;
+
+	/** Keeps the preloaded map alive until the level switch picks it up, a package does not reference its world. */
+	UPROPERTY()
+	UWorld* PreloadedWorld = nullptr;
+
+	FDelegateHandle ProgressTickerHandle;
+	FDelegateHandle PostLoadMapHandle;
+	FDelegateHandle TravelFailureHandle;
+	FDelegateHandle NetworkFailureHandle;
+
+	double RequestTime = 0.0;
+	double SwitchTime = 0.0;
+
+	void OnPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+	bool TickProgress(float DeltaTime);
+	void OnPostLoadMap(UWorld* LoadedWorld);
+	void FinishTransition();
+
+	/** A failed travel never reaches PostLoadMap, so it clears the transition here to let the next one start. */
+	void OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType, const FString& ErrorString);
+	void OnNetworkFailure(UWorld* World, class UNetDriver* NetDriver, ENetworkFailure::Type FailureType, const FString& ErrorString);
+	void ResetTransition();
+};
@@ -20,5 +20,12 @@ class UECOURSE_API IFighterInterface
 	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
 public:
 	virtual int DealDamage();
+
+	/** Applies one queued hit and returns the remaining HP, clamped to the fighter's range. */
 	virtual int TakeDamage(int Damage) = 0;
+
+	virtual bool IsAlive() const = 0;
+
+	/** Called once per frame for a fighter that was hit, after every hit of the frame has been applied. */
+	virtual void OnDamageResolved(int TotalDamage, bool bKilled) {}
 };
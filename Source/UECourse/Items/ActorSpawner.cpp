@@ -5,6 +5,10 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/GameplayStatics.h"
 #include "TestActor.h"
+#include "../Core/CourseNavObstacleSubsystem.h"
+#include "../Core/CourseActorPoolSubsystem.h"
+#include "../Core/CourseSpawnQueueSubsystem.h"
+#include "CourseItemInstanceSubsystem.h"
 
 // Sets default values
 AActorSpawner::AActorSpawner()
@@ -20,34 +24,84 @@ AActorSpawner::AActorSpawner()
 void AActorSpawner::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	UCourseActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UCourseActorPoolSubsystem>();
+
+	if (ActorPool != nullptr && !bInstanceItems)
+	{
+		ActorPool->Prewarm(ItemClass, PoolPrewarmCount);
+	}
 }
 
 void AActorSpawner::Spawn()
 {
-	if (ItemClass != NULL)
+	if (bInstanceItems)
 	{
-		FRotator spawnRotation = FRotator();
+		SpawnInstance();
+		return;
+	}
+
+	UCourseSpawnQueueSubsystem* spawnQueue = GetWorld()->GetSubsystem<UCourseSpawnQueueSubsystem>();
+
+	if (ItemClass != NULL && spawnQueue != nullptr)
+	{
+		FRotator spawnRotation = FRotator::ZeroRotator;
 		FVector spawnLocation = UKismetMathLibrary::RandomPointInBoundingBox(BoxCollision->GetComponentLocation(), BoxCollision->GetScaledBoxExtent());
-		FActorSpawnParameters actorSpawnParameters;
 
-		actorSpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+		spawnQueue->EnqueueSpawn(ItemClass, FTransform(spawnRotation, spawnLocation), SpawnPriority,
+			FCourseOnSpawned::CreateUObject(this, &AActorSpawner::OnItemSpawned), ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding);
+	}
+}
+
+void AActorSpawner::OnItemSpawned(AActor* item)
+{
+	// The queue completes with nothing when the placement was blocked or the actor went away in FinishSpawning
+	if (item == nullptr)
+	{
+		return;
+	}
+
+	SpawnedObjects.Emplace(item);
 
-		AActor* item = GetWorld()->SpawnActor<AActor>(ItemClass, spawnLocation, spawnRotation, actorSpawnParameters);
-		SpawnedObjects.Emplace(item);
+	if (UCourseNavObstacleSubsystem* NavObstacles = GetWorld()->GetSubsystem<UCourseNavObstacleSubsystem>())
+	{
+		NavObstacles->RegisterObstacle(item);
+	}
 
-		if (SpawnedObjects.Num() >= 10)
+	if (SpawnedObjects.Num() >= 10)
+	{
+		UCourseActorPoolSubsystem* actorPool = GetWorld()->GetSubsystem<UCourseActorPoolSubsystem>();
+
+		for (int i = 0; i < SpawnedObjects.Num(); i ++)
+		{
+			actorPool->ReleaseActor(SpawnedObjects[i]);
+		}
+
+		SpawnedObjects.Empty();
+	}
+}
+
+void AActorSpawner::SpawnInstance()
+{
+	UCourseItemInstanceSubsystem* itemInstances = GetWorld()->GetSubsystem<UCourseItemInstanceSubsystem>();
+
+	if (ItemClass == NULL || itemInstances == nullptr)
+	{
+		return;
+	}
+
+	// An instance is only an entry in the batch of its class, so it is added right away
+	FVector spawnLocation = UKismetMathLibrary::RandomPointInBoundingBox(BoxCollision->GetComponentLocation(), BoxCollision->GetScaledBoxExtent());
+	SpawnedInstances.Add(itemInstances->AddInstance(ItemClass, FTransform(spawnLocation), true));
+
+	if (SpawnedInstances.Num() >= 10)
+	{
+		for (int i = 0; i < SpawnedInstances.Num(); i ++)
 		{
-			for (int i = 0; i < SpawnedObjects.Num(); i ++)
-			{
-				if (SpawnedObjects[i] != nullptr)
-				{
-					SpawnedObjects[i]->Destroy();
-				}
-			}
-
-			SpawnedObjects.Empty();
+			itemInstances->RemoveInstance(SpawnedInstances[i]);
 		}
+
+		SpawnedInstances.Empty();
 	}
 }
 
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Components/BoxComponent.h"
+#include "../Core/CourseSpawnQueueSubsystem.h"
 #include "ActorSpawner.generated.h"
 
 UCLASS()
@@ -22,6 +23,8 @@ protected:
 	UFUNCTION(BlueprintCallable)
 	void Spawn();
 
+	void OnItemSpawned(AActor* item);
+
 	UPROPERTY(EditDefaultsOnly)
 	TSubclassOf<class AActor> ItemClass;
 
@@ -30,4 +33,23 @@ protected:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
 	TArray<AActor*> SpawnedObjects;
+
+	/** Actors of ItemClass created in the actor pool at begin play. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
+	int32 PoolPrewarmCount = 10;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
+	ECourseSpawnPriority SpawnPriority = ECourseSpawnPriority::Low;
+
+	/**
+	 * Draws items as instances of ItemClass's static mesh, with its collision, instead of spawning actors.
+	 * Instanced items have no behaviour of their own and do not cut the navmesh.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
+	bool bInstanceItems = false;
+
+	/** Instance handles of the items drawn while bInstanceItems is set. */
+	TArray<int32> SpawnedInstances;
+
+	void SpawnInstance();
 };
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseIndicatorSubsystem.h"
+#include "Indicator.h"
+#include "../UECourse.h"
+#include "../UECourseCharacter.h"
+#include "Curves/CurveFloat.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Indicator Update"), STAT_IndicatorUpdate, STATGROUP_UECourse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Indicators"), STAT_ActiveIndicators, STATGROUP_UECourse);
+
+static FAutoConsoleCommandWithWorldAndArgs CmdIndicatorStress(
+	TEXT("course.Indicators.Stress"),
+	TEXT("Shows N stun indicators around the local player. Usage: course.Indicators.Stress 200"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 200;
+		APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+		AUECourseCharacter* Character = PlayerController ? Cast<AUECourseCharacter>(PlayerController->GetPawn()) : nullptr;
+		UCourseIndicatorSubsystem* IndicatorSubsystem = World ? World->GetSubsystem<UCourseIndicatorSubsystem>() : nullptr;
+
+		if (Character == nullptr || IndicatorSubsystem == nullptr)
+		{
+			return;
+		}
+
+		for (int32 i = 0; i < Count; i++)
+		{
+			const FVector Offset = FMath::VRand() * FMath::FRandRange(100.f, 1000.f);
+			IndicatorSubsystem->ShowIndicator(Character->GetIndicatorClass(), Character->GetActorLocation() + Offset, Offset.Rotation());
+		}
+	}));
+
+bool UCourseIndicatorSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld() && World->GetNetMode() != NM_DedicatedServer;
+}
+
+void UCourseIndicatorSubsystem::Deinitialize()
+{
+	Active.Empty();
+	Pool.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCourseIndicatorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCourseIndicatorSubsystem, STATGROUP_Tickables);
+}
+
+void UCourseIndicatorSubsystem::ShowIndicator(TSubclassOf<AIndicator> IndicatorClass, const FVector& Location, const FRotator& Rotation)
+{
+	AIndicator* Indicator = Acquire(IndicatorClass);
+
+	if (Indicator == nullptr)
+	{
+		return;
+	}
+
+	Indicator->Show(Location, Rotation);
+
+	FActiveIndicator& Entry = Active.AddDefaulted_GetRef();
+	Entry.Indicator = Indicator;
+	Entry.Curve = Indicator->GetUpwardsCurve();
+	Entry.StartLocation = Location;
+	Entry.Duration = Indicator->GetTimelineLength();
+}
+
+void UCourseIndicatorSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_IndicatorUpdate);
+
+	for (int32 i = Active.Num() - 1; i >= 0; i--)
+	{
+		FActiveIndicator& Entry = Active[i];
+		AIndicator* Indicator = Entry.Indicator.Get();
+		Entry.Elapsed += DeltaTime;
+
+		if (Indicator == nullptr || Entry.Elapsed >= Entry.Duration)
+		{
+			Release(Indicator);
+			Active.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		if (Entry.Curve != nullptr)
+		{
+			// Same motion as the old timeline, which added the curve value to the height every update
+			Entry.Height += Entry.Curve->GetFloatValue(Entry.Elapsed);
+			const FVector Location = Entry.StartLocation + FVector(0.f, 0.f, Entry.Height);
+			Indicator->SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ActiveIndicators, Active.Num());
+}
+
+AIndicator* UCourseIndicatorSubsystem::Acquire(TSubclassOf<AIndicator> IndicatorClass)
+{
+	if (IndicatorClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (TArray<TWeakObjectPtr<AIndicator>>* Free = Pool.Find(IndicatorClass))
+	{
+		while (Free->Num() > 0)
+		{
+			if (AIndicator* Indicator = Free->Pop(false).Get())
+			{
+				return Indicator;
+			}
+		}
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	return GetWorld()->SpawnActor<AIndicator>(IndicatorClass, FTransform::Identity, SpawnParameters);
+}
+
+void UCourseIndicatorSubsystem::Release(AIndicator* Indicator)
+{
+	if (Indicator != nullptr)
+	{
+		Indicator->Hide();
+		Pool.FindOrAdd(Indicator->GetClass()).Add(Indicator);
+	}
+}
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CourseIndicatorSubsystem.generated.h"
+
+class AIndicator;
+
+/**
+ * Keeps a pool of indicator actors and moves every active one in a single update,
+ * instead of each indicator ticking its own timeline and destroying itself.
+ */
+UCLASS()
+class UECOURSE_API UCourseIndicatorSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	void ShowIndicator(TSubclassOf<AIndicator> IndicatorClass, const FVector& Location, const FRotator& Rotation);
+
+	int32 GetNumActive() const { return Active.Num(); }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Active.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FActiveIndicator
+	{
+		TWeakObjectPtr<AIndicator> Indicator;
+		const UCurveFloat* Curve = nullptr;
+		FVector StartLocation;
+		float Elapsed = 0.f;
+		float Duration = 0.f;
+		float Height = 0.f;
+	};
+
+	TArray<FActiveIndicator> Active;
+
+	TMap<UClass*, TArray<TWeakObjectPtr<AIndicator>>> Pool;
+
+	AIndicator* Acquire(TSubclassOf<AIndicator> IndicatorClass);
+	void Release(AIndicator* Indicator);
+};
@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CourseItemInstanceSubsystem.h"
+#include "../UECourse.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item Instance Update"), STAT_ItemInstanceUpdate, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Item Instances"), STAT_ItemInstances, STATGROUP_UECourse);
+
+bool UCourseItemInstanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCourseItemInstanceSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_ItemInstances, HandleInstances.Num());
+
+	Batches.Empty();
+	HandleInstances.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 UCourseItemInstanceSubsystem::AddInstance(TSubclassOf<AActor> ItemClass, const FTransform& Transform, bool bCollision)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ItemInstanceUpdate);
+
+	FItemBatch* Batch = ItemClass != nullptr ? FindOrAddBatch(ItemClass, bCollision) : nullptr;
+	UHierarchicalInstancedStaticMeshComponent* Component = Batch != nullptr ? Batch->Component.Get() : nullptr;
+
+	if (Component == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Handle = NextHandle++;
+	const int32 Index = Component->AddInstanceWorldSpace(Batch->MeshTransform * Transform);
+
+	Batch->Handles.Add(Handle);
+
+	HandleInstances.Add(Handle, { FBatchKey(ItemClass.Get(), bCollision), Index });
+	INC_DWORD_STAT(STAT_ItemInstances);
+
+	return Handle;
+}
+
+void UCourseItemInstanceSubsystem::RemoveInstance(int32 Handle)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ItemInstanceUpdate);
+
+	FInstanceLocation Location;
+
+	if (!HandleInstances.RemoveAndCopyValue(Handle, Location))
+	{
+		return;
+	}
+
+	DEC_DWORD_STAT(STAT_ItemInstances);
+
+	FItemBatch* Batch = Batches.Find(Location.Batch);
+	UHierarchicalInstancedStaticMeshComponent* Component = Batch != nullptr ? Batch->Component.Get() : nullptr;
+
+	if (Component == nullptr)
+	{
+		return;
+	}
+
+	// Move the last instance into the freed slot and remove the last one, so only one handle changes its index
+	const int32 LastIndex = Batch->Handles.Num() - 1;
+
+	if (Location.Index != LastIndex)
+	{
+		FTransform LastTransform;
+		Component->GetInstanceTransform(LastIndex, LastTransform, true);
+		Component->UpdateInstanceTransform(Location.Index, LastTransform, true, false, true);
+
+		const int32 MovedHandle = Batch->Handles[LastIndex];
+		Batch->Handles[Location.Index] = MovedHandle;
+		HandleInstances[MovedHandle].Index = Location.Index;
+	}
+
+	Component->RemoveInstance(LastIndex);
+	Batch->Handles.Pop(false);
+}
+
+UCourseItemInstanceSubsystem::FItemBatch* UCourseItemInstanceSubsystem::FindOrAddBatch(UClass* ItemClass, bool bCollision)
+{
+	const FBatchKey Key(ItemClass, bCollision);
+
+	if (FItemBatch* Existing = Batches.Find(Key))
+	{
+		return Existing;
+	}
+
+	const UStaticMeshComponent* Template = FindMeshTemplate(ItemClass);
+
+	if (Template == nullptr || Template->GetStaticMesh() == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has no static mesh to instance"), *ItemClass->GetName());
+		return nullptr;
+	}
+
+	if (!Owner.IsValid())
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParameters.ObjectFlags |= RF_Transient;
+
+		AActor* NewOwner = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+		USceneComponent* Root = NewObject<USceneComponent>(NewOwner, TEXT("Root"));
+		NewOwner->SetRootComponent(Root);
+		Root->RegisterComponent();
+		Owner = NewOwner;
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(Owner.Get());
+	Component->SetupAttachment(Owner->GetRootComponent());
+	Component->SetStaticMesh(Template->GetStaticMesh());
+
+	for (int32 i = 0; i < Template->GetNumOverrideMaterials(); i++)
+	{
+		Component->SetMaterial(i, Template->OverrideMaterials[i]);
+	}
+
+	Component->SetCastShadow(Template->CastShadow);
+
+	if (bCollision)
+	{
+		Component->SetCollisionProfileName(Template->GetCollisionProfileName());
+	}
+	else
+	{
+		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Component->SetCanEverAffectNavigation(false);
+	}
+
+	Component->RegisterComponent();
+	Owner->AddInstanceComponent(Component);
+
+	FItemBatch& Batch = Batches.Add(Key);
+	Batch.Component = Component;
+	Batch.MeshTransform = Template->GetRelativeTransform();
+
+	return &Batch;
+}
+
+const UStaticMeshComponent* UCourseItemInstanceSubsystem::FindMeshTemplate(UClass* ItemClass)
+{
+	// Native components are on the class default object
+	if (const UStaticMeshComponent* Native = ItemClass->GetDefaultObject<AActor>()->FindComponentByClass<UStaticMeshComponent>())
+	{
+		return Native;
+	}
+
+	// Components added in a blueprint only exist as construction script templates
+	for (UBlueprintGeneratedClass* Class = Cast<UBlueprintGeneratedClass>(ItemClass); Class != nullptr; Class = Cast<UBlueprintGeneratedClass>(Class->GetSuperClass()))
+	{
+		if (Class->SimpleConstructionScript == nullptr)
+		{
+			continue;
+		}
+
+		for (const USCS_Node* Node : Class->SimpleConstructionScript->GetAllNodes())
+		{
+			if (const UStaticMeshComponent* Template = Cast<UStaticMeshComponent>(Node->ComponentTemplate))
+			{
+				return Template;
+			}
+		}
+	}
+
+	return nullptr;
+}
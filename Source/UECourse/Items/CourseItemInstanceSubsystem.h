@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CourseItemInstanceSubsystem.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class UStaticMeshComponent;
+
+/**
+ * Draws items as instances of one hierarchical instanced static mesh per item class, instead of an actor per item.
+ * The mesh, materials and collision profile are taken from the static mesh component of the class's defaults.
+ * Instances have no behaviour of their own, gameplay keeps the item's data elsewhere and only adds and removes its look here.
+ */
+UCLASS()
+class UECOURSE_API UCourseItemInstanceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Adds an instance of the item class's mesh at the item transform, with the class's collision when bCollision is set.
+	 * Returns a handle for RemoveInstance, or INDEX_NONE when the class has no static mesh.
+	 */
+	int32 AddInstance(TSubclassOf<AActor> ItemClass, const FTransform& Transform, bool bCollision = false);
+
+	void RemoveInstance(int32 Handle);
+
+	int32 GetNumInstances() const { return HandleInstances.Num(); }
+
+private:
+	typedef TPair<UClass*, bool> FBatchKey;
+
+	struct FItemBatch
+	{
+		TWeakObjectPtr<UHierarchicalInstancedStaticMeshComponent> Component;
+		FTransform MeshTransform;
+
+		/** Handle of each instance index. */
+		TArray<int32> Handles;
+	};
+
+	struct FInstanceLocation
+	{
+		FBatchKey Batch;
+		int32 Index = INDEX_NONE;
+	};
+
+	TMap<FBatchKey, FItemBatch> Batches;
+	TMap<int32, FInstanceLocation> HandleInstances;
+	int32 NextHandle = 1;
+
+	/** Local actor owning the instanced components. */
+	TWeakObjectPtr<AActor> Owner;
+
+	FItemBatch* FindOrAddBatch(UClass* ItemClass, bool bCollision);
+
+	static const UStaticMeshComponent* FindMeshTemplate(UClass* ItemClass);
+};
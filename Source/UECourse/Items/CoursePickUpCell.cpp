@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoursePickUpCell.h"
+#include "CoursePickUpSubsystem.h"
+#include "Net/UnrealNetwork.h"
+
+void FCoursePickUpEntry::PreReplicatedRemove(const FCoursePickUpArray& InArraySerializer)
+{
+	if (UCoursePickUpSubsystem* PickUpSubsystem = UWorld::GetSubsystem<UCoursePickUpSubsystem>(InArraySerializer.Owner->GetWorld()))
+	{
+		PickUpSubsystem->HidePickUp(Id);
+	}
+}
+
+void FCoursePickUpEntry::PostReplicatedAdd(const FCoursePickUpArray& InArraySerializer)
+{
+	if (UCoursePickUpSubsystem* PickUpSubsystem = UWorld::GetSubsystem<UCoursePickUpSubsystem>(InArraySerializer.Owner->GetWorld()))
+	{
+		PickUpSubsystem->ShowPickUp(Id, ItemClass, Location);
+	}
+}
+
+ACoursePickUpCell::ACoursePickUpCell()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent = Root;
+
+	bReplicates = true;
+	SetReplicatingMovement(false);
+	NetUpdateFrequency = 2.f;
+	MinNetUpdateFrequency = 1.f;
+
+	PickUps.Owner = this;
+}
+
+void ACoursePickUpCell::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ACoursePickUpCell, PickUps);
+}
+
+void ACoursePickUpCell::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// A cell leaving a client's relevancy is destroyed there without per item removals
+	if (!HasAuthority())
+	{
+		if (UCoursePickUpSubsystem* PickUpSubsystem = GetWorld()->GetSubsystem<UCoursePickUpSubsystem>())
+		{
+			for (const FCoursePickUpEntry& Entry : PickUps.Items)
+			{
+				PickUpSubsystem->HidePickUp(Entry.Id);
+			}
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ACoursePickUpCell::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	// The cell sits at Z=0, the level's floor can be anywhere above or below it
+	return FVector::DistSquared2D(SrcLocation, GetActorLocation()) < NetCullDistanceSquared;
+}
+
+void ACoursePickUpCell::AddEntry(int32 Id, TSubclassOf<AActor> ItemClass, const FVector& Location)
+{
+	FCoursePickUpEntry& Entry = PickUps.Items.AddDefaulted_GetRef();
+	Entry.Id = Id;
+	Entry.ItemClass = ItemClass;
+	Entry.Location = Location;
+	PickUps.MarkItemDirty(Entry);
+
+	// The cell sends at a low rate while idle, a change goes out on the next net tick
+	ForceNetUpdate();
+}
+
+bool ACoursePickUpCell::RemoveEntry(int32 Id)
+{
+	const int32 Index = PickUps.Items.IndexOfByPredicate([Id](const FCoursePickUpEntry& Entry) { return Entry.Id == Id; });
+
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	PickUps.Items.RemoveAtSwap(Index, 1, false);
+	PickUps.MarkArrayDirty();
+	ForceNetUpdate();
+
+	return true;
+}
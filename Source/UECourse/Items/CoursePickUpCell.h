@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "CoursePickUpCell.generated.h"
+
+class ACoursePickUpCell;
+
+/** One pickup, as replicated to clients. */
+USTRUCT()
+struct UECOURSE_API FCoursePickUpEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Id = 0;
+
+	/** Class implementing IPickUpInterface, its default object holds the pickup's effect and look. */
+	UPROPERTY()
+	TSubclassOf<AActor> ItemClass;
+
+	UPROPERTY()
+	FVector_NetQuantize Location = FVector::ZeroVector;
+
+	void PreReplicatedRemove(const struct FCoursePickUpArray& InArraySerializer);
+	void PostReplicatedAdd(const struct FCoursePickUpArray& InArraySerializer);
+};
+
+/** Pickups of a cell, only additions and removals are sent. */
+USTRUCT()
+struct UECOURSE_API FCoursePickUpArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FCoursePickUpEntry> Items;
+
+	ACoursePickUpCell* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FCoursePickUpEntry, FCoursePickUpArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FCoursePickUpArray> : public TStructOpsTypeTraitsBase2<FCoursePickUpArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+/**
+ * Replicates the pickups of one grid cell, placed at the cell's center.
+ * Clients only receive cells within NetCullDistance of their view, measured on the ground plane since a cell covers every
+ * height, and lose them again when they move away.
+ * Cells are not dormant, relevancy is not re-checked for dormant actors, they are considered a few times a second instead.
+ */
+UCLASS(NotPlaceable)
+class UECOURSE_API ACoursePickUpCell : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ACoursePickUpCell();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	void AddEntry(int32 Id, TSubclassOf<AActor> ItemClass, const FVector& Location);
+	bool RemoveEntry(int32 Id);
+
+	const TArray<FCoursePickUpEntry>& GetEntries() const { return PickUps.Items; }
+
+protected:
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	USceneComponent* Root;
+
+	UPROPERTY(Replicated)
+	FCoursePickUpArray PickUps;
+};
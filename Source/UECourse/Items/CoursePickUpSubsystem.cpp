@@ -0,0 +1,284 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoursePickUpSubsystem.h"
+#include "CoursePickUpCell.h"
+#include "../UECourse.h"
+#include "../UECourseCharacter.h"
+#include "../PickUpInterface.h"
+#include "../Core/CourseActorRegistrySubsystem.h"
+#include "../Core/CourseActorPoolSubsystem.h"
+#include "../Core/CourseSpawnQueueSubsystem.h"
+#include "CourseItemInstanceSubsystem.h"
+#include "Components/CapsuleComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("PickUp Collection"), STAT_PickUpCollection, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("PickUps"), STAT_PickUps, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("PickUp Visuals"), STAT_PickUpVisuals, STATGROUP_UECourse);
+
+static float PickUpNetCullDistance = 5000.f;
+static FAutoConsoleVariableRef CVarPickUpNetCullDistance(
+	TEXT("course.PickUp.NetCullDistance"),
+	PickUpNetCullDistance,
+	TEXT("Distance from a client's view within which pickup cells replicate to it. Applies to cells created afterwards."));
+
+static float PickUpRadius = 50.f;
+static FAutoConsoleVariableRef CVarPickUpRadius(
+	TEXT("course.PickUp.Radius"),
+	PickUpRadius,
+	TEXT("Distance from a character's capsule within which the server collects a pickup."));
+
+/** Size of a replicated pickup cell, larger than any collection reach so a 3x3 neighbourhood covers it. */
+static constexpr float PickUpCellSize = 2000.f;
+
+bool UCoursePickUpSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UCoursePickUpSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_PickUps, PickUpCells.Num());
+	DEC_DWORD_STAT_BY(STAT_PickUpVisuals, Visuals.Num());
+
+	Cells.Empty();
+	PickUpCells.Empty();
+	Visuals.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCoursePickUpSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCoursePickUpSubsystem, STATGROUP_Tickables);
+}
+
+bool UCoursePickUpSubsystem::IsTickable() const
+{
+	// Collection is only decided by the server
+	return PickUpCells.Num() > 0 && GetWorld() != nullptr && GetWorld()->GetNetMode() != NM_Client;
+}
+
+FIntPoint UCoursePickUpSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / PickUpCellSize), FMath::FloorToInt(Location.Y / PickUpCellSize));
+}
+
+ACoursePickUpCell* UCoursePickUpSubsystem::FindOrAddCell(const FIntPoint& Cell)
+{
+	if (ACoursePickUpCell* Existing = Cells.FindRef(Cell).Get())
+	{
+		return Existing;
+	}
+
+	const FVector Center((Cell.X + 0.5f) * PickUpCellSize, (Cell.Y + 0.5f) * PickUpCellSize, 0.f);
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ACoursePickUpCell* NewCell = GetWorld()->SpawnActor<ACoursePickUpCell>(ACoursePickUpCell::StaticClass(), FTransform(Center), SpawnParameters);
+
+	if (NewCell != nullptr)
+	{
+		// Measured from the cell's center, so add half a cell diagonal to keep its corners in range
+		NewCell->NetCullDistanceSquared = FMath::Square(PickUpNetCullDistance + PickUpCellSize * FMath::Sqrt(0.5f));
+		Cells.Add(Cell, NewCell);
+	}
+
+	return NewCell;
+}
+
+int32 UCoursePickUpSubsystem::AddPickUp(TSubclassOf<AActor> ItemClass, const FVector& Location)
+{
+	if (GetWorld()->GetNetMode() == NM_Client || ItemClass == nullptr || !ItemClass->ImplementsInterface(UPickUpInterface::StaticClass()))
+	{
+		return INDEX_NONE;
+	}
+
+	const FIntPoint Cell = GetCell(Location);
+	ACoursePickUpCell* CellActor = FindOrAddCell(Cell);
+
+	if (CellActor == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 PickUpId = NextPickUpId++;
+	CellActor->AddEntry(PickUpId, ItemClass, Location);
+	PickUpCells.Add(PickUpId, Cell);
+	INC_DWORD_STAT(STAT_PickUps);
+
+	// Replication never calls back into the server, so a listen server shows its own pickups
+	if (GetWorld()->GetNetMode() != NM_DedicatedServer)
+	{
+		ShowPickUp(PickUpId, ItemClass, Location);
+	}
+
+	return PickUpId;
+}
+
+bool UCoursePickUpSubsystem::RemovePickUp(int32 PickUpId)
+{
+	FIntPoint Cell;
+
+	if (!PickUpCells.RemoveAndCopyValue(PickUpId, Cell))
+	{
+		return false;
+	}
+
+	DEC_DWORD_STAT(STAT_PickUps);
+
+	if (ACoursePickUpCell* CellActor = Cells.FindRef(Cell).Get())
+	{
+		CellActor->RemoveEntry(PickUpId);
+	}
+
+	if (GetWorld()->GetNetMode() != NM_DedicatedServer)
+	{
+		HidePickUp(PickUpId);
+	}
+
+	return true;
+}
+
+void UCoursePickUpSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PickUpCollection);
+
+	UCourseActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UCourseActorRegistrySubsystem>();
+
+	if (Registry == nullptr)
+	{
+		return;
+	}
+
+	TArray<AUECourseCharacter*> Characters;
+	Registry->GetActorsOfClass<AUECourseCharacter>(Characters);
+
+	for (AUECourseCharacter* Character : Characters)
+	{
+		CollectPickUps(Character);
+	}
+}
+
+void UCoursePickUpSubsystem::CollectPickUps(AUECourseCharacter* Character)
+{
+	const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+	const FVector Center = Capsule->GetComponentLocation();
+	const float Reach = Capsule->GetScaledCapsuleRadius() + PickUpRadius;
+	const float HeightReach = Capsule->GetScaledCapsuleHalfHeight() + PickUpRadius;
+	const FIntPoint CharacterCell = GetCell(Center);
+
+	// Collected after the scan, removal reorders the cell's entries
+	TArray<TPair<int32, TSubclassOf<AActor>>, TInlineAllocator<4>> Collected;
+
+	for (int32 Y = CharacterCell.Y - 1; Y <= CharacterCell.Y + 1; Y++)
+	{
+		for (int32 X = CharacterCell.X - 1; X <= CharacterCell.X + 1; X++)
+		{
+			const ACoursePickUpCell* CellActor = Cells.FindRef(FIntPoint(X, Y)).Get();
+
+			if (CellActor == nullptr)
+			{
+				continue;
+			}
+
+			for (const FCoursePickUpEntry& Entry : CellActor->GetEntries())
+			{
+				if (FVector::DistSquared2D(Entry.Location, Center) <= FMath::Square(Reach) && FMath::Abs(Entry.Location.Z - Center.Z) <= HeightReach)
+				{
+					Collected.Emplace(Entry.Id, Entry.ItemClass);
+				}
+			}
+		}
+	}
+
+	for (const TPair<int32, TSubclassOf<AActor>>& PickUp : Collected)
+	{
+		// The effect lives on the class, so the class default object answers for every pickup of it
+		IPickUpInterface* PickUpInterface = PickUp.Value ? Cast<IPickUpInterface>(PickUp.Value->GetDefaultObject()) : nullptr;
+		const int32 HitPoints = PickUpInterface != nullptr ? PickUpInterface->Interact() : 0;
+
+		RemovePickUp(PickUp.Key);
+		Character->CollectPickUp(HitPoints);
+		OnPickUpCollected.Broadcast(PickUp.Key, Character, HitPoints);
+	}
+}
+
+void UCoursePickUpSubsystem::ShowPickUp(int32 PickUpId, TSubclassOf<AActor> ItemClass, const FVector& Location)
+{
+	if (ItemClass == nullptr || Visuals.Contains(PickUpId))
+	{
+		return;
+	}
+
+	FPickUpVisual& Visual = Visuals.Add(PickUpId);
+	INC_DWORD_STAT(STAT_PickUpVisuals);
+
+	// One instanced mesh per item type draws every pickup of it
+	if (UCourseItemInstanceSubsystem* ItemInstances = GetWorld()->GetSubsystem<UCourseItemInstanceSubsystem>())
+	{
+		Visual.Instance = ItemInstances->AddInstance(ItemClass, FTransform(Location));
+	}
+
+	// Items without a static mesh to instance are still shown as actors
+	if (Visual.Instance != INDEX_NONE)
+	{
+		return;
+	}
+
+	if (UCourseSpawnQueueSubsystem* SpawnQueue = GetWorld()->GetSubsystem<UCourseSpawnQueueSubsystem>())
+	{
+		Visual.SpawnRequest = SpawnQueue->EnqueueSpawn(ItemClass, FTransform(Location), ECourseSpawnPriority::Normal,
+			FCourseOnSpawned::CreateUObject(this, &UCoursePickUpSubsystem::HandleVisualSpawned, PickUpId));
+	}
+}
+
+void UCoursePickUpSubsystem::HidePickUp(int32 PickUpId)
+{
+	FPickUpVisual Visual;
+
+	if (!Visuals.RemoveAndCopyValue(PickUpId, Visual))
+	{
+		return;
+	}
+
+	DEC_DWORD_STAT(STAT_PickUpVisuals);
+
+	if (Visual.Instance != INDEX_NONE)
+	{
+		if (UCourseItemInstanceSubsystem* ItemInstances = GetWorld()->GetSubsystem<UCourseItemInstanceSubsystem>())
+		{
+			ItemInstances->RemoveInstance(Visual.Instance);
+		}
+	}
+	else if (AActor* Actor = Visual.Actor.Get())
+	{
+		UCourseActorPoolSubsystem::ReleaseOrDestroy(Actor);
+	}
+	else if (UCourseSpawnQueueSubsystem* SpawnQueue = GetWorld()->GetSubsystem<UCourseSpawnQueueSubsystem>())
+	{
+		SpawnQueue->CancelSpawn(Visual.SpawnRequest);
+	}
+}
+
+void UCoursePickUpSubsystem::HandleVisualSpawned(AActor* Actor, int32 PickUpId)
+{
+	FPickUpVisual* Visual = Visuals.Find(PickUpId);
+
+	if (Actor == nullptr)
+	{
+		return;
+	}
+
+	if (Visual == nullptr)
+	{
+		UCourseActorPoolSubsystem::ReleaseOrDestroy(Actor);
+		return;
+	}
+
+	// Only the look is local, collection is decided by the server from the entry
+	Actor->SetActorEnableCollision(false);
+	Visual->Actor = Actor;
+	Visual->SpawnRequest = INDEX_NONE;
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CoursePickUpSubsystem.generated.h"
+
+class ACoursePickUpCell;
+
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FCourseOnPickUpCollected, int32 /*PickUpId*/, AActor* /*Collector*/, int32 /*HitPoints*/);
+
+/**
+ * Server-owned registry of the pickups in a world.
+ * Pickups are entries in the fast arrays of per-cell replicated actors, so clients only hear about pickups near them.
+ * The server checks the players against the cells around them and applies a collection once, every other machine
+ * only shows or hides the pickup when its entry arrives or goes away.
+ */
+UCLASS()
+class UECOURSE_API UCoursePickUpSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/** Adds a pickup of a class implementing IPickUpInterface. Server only, returns the id or INDEX_NONE. */
+	int32 AddPickUp(TSubclassOf<AActor> ItemClass, const FVector& Location);
+
+	/** Removes a pickup without collecting it. Server only. */
+	bool RemovePickUp(int32 PickUpId);
+
+	int32 GetNumPickUps() const { return PickUpCells.Num(); }
+
+	/** Called on the server after a collection has been applied to the collector. */
+	FCourseOnPickUpCollected OnPickUpCollected;
+
+	/** Shows the local look of a pickup, called for replicated entries and for the listen server's own. */
+	void ShowPickUp(int32 PickUpId, TSubclassOf<AActor> ItemClass, const FVector& Location);
+	void HidePickUp(int32 PickUpId);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	TMap<FIntPoint, TWeakObjectPtr<ACoursePickUpCell>> Cells;
+	TMap<int32, FIntPoint> PickUpCells;
+	int32 NextPickUpId = 1;
+
+	struct FPickUpVisual
+	{
+		int32 Instance = INDEX_NONE;
+		TWeakObjectPtr<AActor> Actor;
+		int32 SpawnRequest = INDEX_NONE;
+	};
+
+	TMap<int32, FPickUpVisual> Visuals;
+
+	FIntPoint GetCell(const FVector& Location) const;
+	ACoursePickUpCell* FindOrAddCell(const FIntPoint& Cell);
+	void CollectPickUps(class AUECourseCharacter* Character);
+	void HandleVisualSpawned(AActor* Actor, int32 PickUpId);
+};
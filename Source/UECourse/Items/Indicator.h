@@ -6,6 +6,7 @@
 #include "GameFramework/Actor.h"
 #include "Indicator.generated.h"
 
+/** Floating stun indicator, pooled and animated by UCourseIndicatorSubsystem. */
 UCLASS()
 class UECOURSE_API AIndicator : public AActor
 {
@@ -14,13 +15,11 @@ class UECOURSE_API AIndicator : public AActor
 public:
 	AIndicator();
 
-protected:
-	virtual void BeginPlay() override;
+	UCurveFloat* GetUpwardsCurve() const { return UpwardsCurve; }
+	float GetTimelineLength() const { return TimelineLenght; }
 
-	void SetupAndPlayTimelineForMovingUpwards();
-
-public:
-	virtual void Tick(float DeltaTime) override;
+	void Show(const FVector& Location, const FRotator& Rotation);
+	void Hide();
 
 private:
 	UPROPERTY(EditDefaultsOnly, meta = (AllowPrivateAccess = "true"), Category = "Timeline")
@@ -28,13 +27,4 @@ private:
 
 	UPROPERTY(EditDefaultsOnly, meta = (AllowPrivateAccess = "true"), Category = "Timeline")
 	float TimelineLenght = 3.f;
-
-	UFUNCTION()
-	void UpdateTimeline(float Value);
-
-	UFUNCTION()
-	void TimelineFinished();
-
-	class UTimelineComponent* MovingUpwardsTimeline;
-
 };
@@ -4,12 +4,13 @@
 #include "PickUp.h"
 #include "Kismet/GameplayStatics.h"
 #include "../UECourseCharacter.h"
+#include "CoursePickUpSubsystem.h"
 
 // Sets default values
 APickUp::APickUp()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// Pickups are drawn as instances and collected by the pickup subsystem, nothing to update per frame
+	PrimaryActorTick.bCanEverTick = false;
 	
 	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 	Root->SetupAttachment(RootComponent);
@@ -22,6 +23,23 @@ APickUp::APickUp()
 void APickUp::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Pickups placed in the level become subsystem entries like spawned ones, spawned looks are left alone
+	if (!IsNetStartupActor())
+	{
+		return;
+	}
+
+	if (GetNetMode() != NM_Client)
+	{
+		if (UCoursePickUpSubsystem* PickUpSubsystem = GetWorld()->GetSubsystem<UCoursePickUpSubsystem>())
+		{
+			PickUpSubsystem->AddPickUp(GetClass(), GetActorLocation());
+		}
+	}
+
+	// Clients show the replicated entry instead of their own copy of the level actor
+	Destroy();
 }
 
 // Called every frame
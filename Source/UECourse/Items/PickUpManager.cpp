@@ -4,6 +4,7 @@
 #include "PickUpManager.h"
 #include "../UECourseCharacter.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "CoursePickUpSubsystem.h"
 
 // Sets default values
 APickUpManager::APickUpManager()
@@ -17,18 +18,27 @@ APickUpManager::APickUpManager()
 void APickUpManager::BeginPlay()
 {
 	Super::BeginPlay();
-	
-	AUECourseCharacter* character = Cast<AUECourseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
 
-	if (character != nullptr)
+	// Collections are only applied on the server
+	if (UCoursePickUpSubsystem* PickUps = GetWorld()->GetSubsystem<UCoursePickUpSubsystem>())
 	{
-		character->OnItemCollected.AddDynamic(this, &APickUpManager::Log);
+		PickUps->OnPickUpCollected.AddUObject(this, &APickUpManager::Log);
 	}
 }
 
-void APickUpManager::Log(int hp)
+void APickUpManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	AUECourseCharacter* character = Cast<AUECourseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
+	if (UCoursePickUpSubsystem* PickUps = GetWorld()->GetSubsystem<UCoursePickUpSubsystem>())
+	{
+		PickUps->OnPickUpCollected.RemoveAll(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APickUpManager::Log(int32 pickUpId, AActor* collector, int32 hp)
+{
+	AUECourseCharacter* character = Cast<AUECourseCharacter>(collector);
 
 	if (character == nullptr)
 	{
@@ -2,9 +2,11 @@
 
 
 #include "PickUpSpawner.h"
-#include "../UECourseCharacter.h"
-#include "Kismet/KismetMathLibrary.h"
 #include "Kismet/GameplayStatics.h"
+#include "../Core/CourseActorPoolSubsystem.h"
+#include "../Core/CourseSpawnPointSubsystem.h"
+#include "CoursePickUpSubsystem.h"
+#include "TimerManager.h"
 
 // Sets default values
 APickUpSpawner::APickUpSpawner()
@@ -21,16 +23,49 @@ void APickUpSpawner::BeginPlay()
 {
 	Super::BeginPlay();
 
-	AUECourseCharacter* character = Cast<AUECourseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
+	UCourseActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UCourseActorPoolSubsystem>();
 
-	if (character != nullptr)
+	if (ActorPool != nullptr && GetNetMode() != NM_DedicatedServer)
 	{
-		character->OnItemCollected.AddDynamic(this, &APickUpSpawner::Spawn);
+		ActorPool->Prewarm(ItemClass, PoolPrewarmCount);
+	}
+
+	// Pickups are owned by the server, clients receive them through the pickup subsystem
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	if (UCourseSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UCourseSpawnPointSubsystem>())
+	{
+		SpawnPointSet = SpawnPoints->RegisterVolume(BoxCollision, SpawnPointSpacing, SpawnPointClearance);
+	}
+
+	if (UCoursePickUpSubsystem* PickUps = GetWorld()->GetSubsystem<UCoursePickUpSubsystem>())
+	{
+		PickUps->OnPickUpCollected.AddUObject(this, &APickUpSpawner::HandlePickUpCollected);
 	}
 
 	Spawn(0.f);
 }
 
+void APickUpSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCourseSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UCourseSpawnPointSubsystem>())
+	{
+		SpawnPoints->UnregisterVolume(SpawnPointSet);
+	}
+
+	if (UCoursePickUpSubsystem* PickUps = GetWorld()->GetSubsystem<UCoursePickUpSubsystem>())
+	{
+		PickUps->OnPickUpCollected.RemoveAll(this);
+	}
+
+	GetWorldTimerManager().ClearTimer(RetryTimer);
+
+	Super::EndPlay(EndPlayReason);
+}
+
 // Called every frame
 void APickUpSpawner::Tick(float DeltaTime)
 {
@@ -40,19 +75,64 @@ void APickUpSpawner::Tick(float DeltaTime)
 
 void APickUpSpawner::Spawn(int hp)
 {
-	if (ItemClass != nullptr)
+	PendingSpawns++;
+	SpawnPending();
+}
+
+void APickUpSpawner::SpawnPending()
+{
+	UCoursePickUpSubsystem* pickUps = GetWorld()->GetSubsystem<UCoursePickUpSubsystem>();
+	UCourseSpawnPointSubsystem* spawnPoints = GetWorld()->GetSubsystem<UCourseSpawnPointSubsystem>();
+
+	if (ItemClass == nullptr || pickUps == nullptr || spawnPoints == nullptr || !HasAuthority())
+	{
+		return;
+	}
+
+	while (PendingSpawns > 0)
 	{
-		FRotator spawnRotation = FRotator();
-		FVector spawnLocation = UKismetMathLibrary::RandomPointInBoundingBox(BoxCollision->GetComponentLocation(), BoxCollision->GetScaledBoxExtent());
-		spawnLocation.Z = BoxCollision->GetComponentLocation().Z;
-		FActorSpawnParameters actorSpawnParameters;
+		FVector spawnLocation;
+		int32 point;
 
-		actorSpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+		if (!spawnPoints->AcquirePoint(SpawnPointSet, spawnLocation, point))
+		{
+			// Points are still being tested, try again later instead of blocking the frame
+			if (!spawnPoints->IsReady(SpawnPointSet))
+			{
+				GetWorldTimerManager().SetTimer(RetryTimer, this, &APickUpSpawner::SpawnPending, 0.25f);
+			}
+
+			// Otherwise every point is taken, the next collection frees one and spawns again
+			return;
+		}
+
+		// The point is known to be clear, a pickup is only an entry until a machine shows it
+		const int32 pickUpId = pickUps->AddPickUp(ItemClass, spawnLocation);
 
-		AActor* item;
-		do 
+		if (pickUpId == INDEX_NONE)
 		{
-			item = GetWorld()->SpawnActor<AActor>(ItemClass, spawnLocation, spawnRotation, actorSpawnParameters);
-		} while (item == nullptr);
+			spawnPoints->ReleasePoint(SpawnPointSet, point);
+			return;
+		}
+
+		PlacedPickUps.Add(pickUpId, point);
+		PendingSpawns--;
+	}
+}
+
+void APickUpSpawner::HandlePickUpCollected(int32 pickUpId, AActor* collector, int32 hp)
+{
+	int32 point;
+
+	if (!PlacedPickUps.RemoveAndCopyValue(pickUpId, point))
+	{
+		return;
 	}
-}
\ No newline at end of file
+
+	if (UCourseSpawnPointSubsystem* spawnPoints = GetWorld()->GetSubsystem<UCourseSpawnPointSubsystem>())
+	{
+		spawnPoints->ReleasePoint(SpawnPointSet, point);
+	}
+
+	Spawn(hp);
+}
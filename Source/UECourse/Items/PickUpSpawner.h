@@ -17,9 +17,12 @@ public:
 	APickUpSpawner();
 	virtual void Tick(float DeltaTime) override;
 
+	TSubclassOf<AActor> GetItemClass() const { return ItemClass; }
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UFUNCTION(BlueprintCallable)
 	void Spawn(int hp);
@@ -29,4 +32,30 @@ protected:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Components")
 	UBoxComponent* BoxCollision;
+
+	/**
+	 * Actors of ItemClass created in the actor pool at begin play on machines that render.
+	 * Only needed when ItemClass has no static mesh, otherwise pickups are drawn as instances.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
+	int32 PoolPrewarmCount = 0;
+
+	/** Minimum distance between precomputed spawn points. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
+	float SpawnPointSpacing = 200.f;
+
+	/** Radius around a spawn point that must be free of static geometry. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
+	float SpawnPointClearance = 50.f;
+
+private:
+	/** Spawn point taken by each pickup this spawner added. */
+	TMap<int32, int32> PlacedPickUps;
+
+	int32 SpawnPointSet = INDEX_NONE;
+	int32 PendingSpawns = 0;
+	FTimerHandle RetryTimer;
+
+	void SpawnPending();
+	void HandlePickUpCollected(int32 pickUpId, AActor* collector, int32 hp);
 };
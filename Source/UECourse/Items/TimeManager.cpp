@@ -4,33 +4,72 @@
 #include "TimeManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "../UECourseGameMode.h"
+#include "../Core/CourseTimeOfDaySubsystem.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/UnrealNetwork.h"
 
 // Sets default values
 ATimeManager::ATimeManager()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
+	bReplicates = true;
+	bAlwaysRelevant = true;
 }
 
 // Called when the game starts or when spawned
 void ATimeManager::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (HasAuthority())
+	{
+		const AGameStateBase* GameState = GetWorld()->GetGameState();
+		StartServerTime = GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+
+		if (UCourseTimeOfDaySubsystem* TimeOfDay = GetWorld()->GetSubsystem<UCourseTimeOfDaySubsystem>())
+		{
+			TimeOfDay->OnHourChanged.AddUObject(this, &ATimeManager::HandleHourChanged);
+		}
+
+		StartClock();
+	}
 }
 
-// Called every frame
-void ATimeManager::Tick(float DeltaTime)
+void ATimeManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	Super::Tick(DeltaTime);
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	Hour += DeltaTime * 0.1;
-	Hour = FMath::Clamp(Hour, 0.f, 24.f);
+	// The clock is set once, clients extrapolate from it
+	DOREPLIFETIME_CONDITION(ATimeManager, StartHour, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ATimeManager, HoursPerSecond, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION_NOTIFY(ATimeManager, StartServerTime, COND_InitialOnly, REPNOTIFY_Always);
+}
 
-	if (AUECourseGameMode* GameMode = Cast<AUECourseGameMode>(UGameplayStatics::GetGameMode(GetWorld())))
+void ATimeManager::OnRep_StartServerTime()
+{
+	StartClock();
+}
+
+void ATimeManager::StartClock()
+{
+	if (UCourseTimeOfDaySubsystem* TimeOfDay = GetWorld()->GetSubsystem<UCourseTimeOfDaySubsystem>())
 	{
-		GameMode->Hour = Hour;
+		TimeOfDay->SetClock(StartServerTime, StartHour, HoursPerSecond);
 	}
 }
 
+float ATimeManager::GetHour() const
+{
+	const UCourseTimeOfDaySubsystem* TimeOfDay = GetWorld()->GetSubsystem<UCourseTimeOfDaySubsystem>();
+	return TimeOfDay != nullptr ? TimeOfDay->GetHour() : StartHour;
+}
+
+void ATimeManager::HandleHourChanged(int32 NewHour)
+{
+	// Kept for Blueprints that still read the hour from the game mode
+	if (AUECourseGameMode* GameMode = Cast<AUECourseGameMode>(UGameplayStatics::GetGameMode(GetWorld())))
+	{
+		GameMode->Hour = NewHour;
+	}
+}
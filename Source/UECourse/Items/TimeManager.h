@@ -6,6 +6,10 @@
 #include "GameFramework/Actor.h"
 #include "TimeManager.generated.h"
 
+/**
+ * Starts the world's game clock. The server replicates the time it started the clock at once,
+ * the time of day subsystem computes the current hour from it on every machine.
+ */
 UCLASS()
 class UECOURSE_API ATimeManager : public AActor
 {
@@ -14,12 +18,29 @@ class UECOURSE_API ATimeManager : public AActor
 public:	
 	// Sets default values for this actor's properties
 	ATimeManager();
-	virtual void Tick(float DeltaTime) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION(BlueprintPure, Category = "Variables")
+	float GetHour() const;
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
-	float Hour = 0.f;
+	/** Hour the clock starts at. It does not advance, read the current hour with GetHour(). */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = "Variables")
+	float StartHour = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = "Variables")
+	float HoursPerSecond = 0.1f;
+
+	UPROPERTY(ReplicatedUsing = OnRep_StartServerTime)
+	float StartServerTime = 0.f;
+
+	UFUNCTION()
+	void OnRep_StartServerTime();
+
+	void StartClock();
+	void HandleHourChanged(int32 NewHour);
 };
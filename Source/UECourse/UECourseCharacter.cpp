@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "UECourseCharacter.h"
+#include "UECourse.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
@@ -13,7 +14,26 @@
 #include "Items/PickUp.h"
 #include "UI/CharacterWidget.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "Items/Indicator.h"
+#include "Items/CourseIndicatorSubsystem.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "Core/CourseRewindSubsystem.h"
+#include "Core/CourseActorRegistrySubsystem.h"
+#include "Core/CourseTransitionSubsystem.h"
+#include "Core/CourseDamageSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Serialization/BitWriter.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Predicted Claw Attacks"), STAT_PredictedClawAttacks, STATGROUP_UECourse);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Mispredicted Claw Attacks"), STAT_MispredictedClawAttacks, STATGROUP_UECourse);
+
+static int32 GLogInputBandwidth = 0;
+static FAutoConsoleVariableRef CVarLogInputBandwidth(
+	TEXT("course.Net.LogInputBandwidth"),
+	GLogInputBandwidth,
+	TEXT("Log the input packet payload bytes/sec sent by the locally controlled character."));
 
 //////////////////////////////////////////////////////////////////////////
 // AUECourseCharacter
@@ -22,6 +42,9 @@ AUECourseCharacter::AUECourseCharacter()
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
+
+	// Claw hits and spider contact are checked against the rewind history and pickups by the pickup subsystem, so moves never update overlaps
+	GetCapsuleComponent()->SetGenerateOverlapEvents(false);
 	
 	// set our turn rates for input
 	BaseTurnRate = 45.f;
@@ -60,47 +83,91 @@ void AUECourseCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 	
-	GetCapsuleComponent()->OnComponentBeginOverlap.AddDynamic(this, &AUECourseCharacter::OnOverlapBegin);
+	if (HasAuthority())
+	{
+		if (UCourseRewindSubsystem* RewindSubsystem = GetWorld()->GetSubsystem<UCourseRewindSubsystem>())
+		{
+			RewindSubsystem->RegisterFighter(this);
+		}
+	}
+}
 
-	
+void AUECourseCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCourseRewindSubsystem* RewindSubsystem = GetWorld()->GetSubsystem<UCourseRewindSubsystem>())
+	{
+		RewindSubsystem->UnregisterFighter(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void AUECourseCharacter::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int OtherBodyIndex, bool FromSweep, const FHitResult& SweepResult)
+void AUECourseCharacter::Tick(float DeltaSeconds)
 {
-	if (OtherActor->GetClass()->ImplementsInterface(UPickUpInterface::StaticClass()))
+	Super::Tick(DeltaSeconds);
+
+	if (IsLocallyControlled())
 	{
-		PickUp(OtherActor);
+		SendInput(DeltaSeconds);
 	}
 
-	if (!HasAuthority())
+	if (bAttackAckPending && GetWorld()->GetTimeSeconds() - PredictedAttackTime > AttackAckTimeout)
+	{
+		// The input frames carrying the attack were all lost
+		bAttackAckPending = false;
+		RollbackPredictedAttack();
+	}
+
+	if (HasAuthority())
+	{
+		ApplyInput();
+	}
+}
+
+void AUECourseCharacter::ValidateClawHit()
+{
+	UCourseRewindSubsystem* RewindSubsystem = GetWorld()->GetSubsystem<UCourseRewindSubsystem>();
+
+	if (RewindSubsystem == nullptr)
 	{
 		return;
 	}
 
-	if (OtherActor && OtherActor != this)
+	// Rewind the other fighters to what the attacking client saw when it pressed attack
+	float ViewDelay = 0.f;
+
+	if (!IsLocallyControlled() && GetPlayerState() != nullptr)
+	{
+		ViewDelay = FMath::Min(GetPlayerState()->ExactPing * 0.5f * 0.001f, MaxRewindTime);
+	}
+
+	const FVector Start = GetActorLocation();
+	const FVector End = Start + GetActorForwardVector() * ClawReach;
+	TArray<ACharacter*> Hits;
+	RewindSubsystem->SweepFighters(this, Start, End, ClawRadius, GetWorld()->GetTimeSeconds() - ViewDelay, Hits);
+
+	for (ACharacter* Hit : Hits)
 	{
-		if (AUECourseCharacter* OtherCourseCharacter = Cast<AUECourseCharacter>(OtherActor))
+		AUECourseCharacter* OtherCourseCharacter = Cast<AUECourseCharacter>(Hit);
+
+		if (OtherCourseCharacter != nullptr && OtherCourseCharacter->StunBegin_Validate())
 		{
-			if (OtherCourseCharacter->bAttack)
-			{
-				if (StunBegin_Validate())
-				{
-					StunBegin();
-					StunIndicatorSpawn(OverlappedComponent->GetComponentLocation());
-				}
-			}
+			OtherCourseCharacter->StunBegin();
+			OtherCourseCharacter->StunIndicatorSpawn(OtherCourseCharacter->GetCapsuleComponent()->GetComponentLocation());
 		}
 	}
 }
 
-void AUECourseCharacter::StunIndicatorSpawn_Implementation(FVector Location)
+void AUECourseCharacter::StunIndicatorSpawn(const FVector& Location)
 {
 	StunIndicatorSpawn_Multicast(Location);
 }
 
-void AUECourseCharacter::StunIndicatorSpawn_Multicast_Implementation(FVector Location)
+void AUECourseCharacter::StunIndicatorSpawn_Multicast_Implementation(FVector_NetQuantize Location)
 {
-	if (IndicatorClass)
+	UCourseIndicatorSubsystem* IndicatorSubsystem = GetWorld()->GetSubsystem<UCourseIndicatorSubsystem>();
+
+	if (IndicatorClass && IndicatorSubsystem)
 	{
 		if (APlayerController* PlayerController = GetWorld()->GetFirstPlayerController())
 		{
@@ -110,7 +177,7 @@ void AUECourseCharacter::StunIndicatorSpawn_Multicast_Implementation(FVector Loc
 			const FVector DirectionToCamera = PlayerCameraLocation - GetActorLocation();
 			const FRotator SpawnRotation = DirectionToCamera.Rotation();
 
-			GetWorld()->SpawnActor<AIndicator>(IndicatorClass, Location, SpawnRotation);
+			IndicatorSubsystem->ShowIndicator(IndicatorClass, Location, SpawnRotation);
 		}
 	}
 }
@@ -124,7 +191,7 @@ bool AUECourseCharacter::StunBegin_Validate()
 	return true;
 }
 
-void AUECourseCharacter::StunBegin_Implementation()
+void AUECourseCharacter::StunBegin()
 {
 	if (StunTimerHandle.IsValid())
 	{
@@ -132,38 +199,84 @@ void AUECourseCharacter::StunBegin_Implementation()
 	}
 	GetWorldTimerManager().SetTimer(StunTimerHandle, this, &AUECourseCharacter::StunFinished, StunTime, false);
 
-	StunBegin_Multicast();
+	FCourseCombatState NewCombatState = CombatState;
+	NewCombatState.bStunned = true;
+	NewCombatState.bUseControllerRotationYaw = false;
+	NewCombatState.StunStartServerTime = GetWorld()->GetTimeSeconds();
+	SetCombatState(NewCombatState);
 }
 
-void AUECourseCharacter::StunBegin_Multicast_Implementation()
+void AUECourseCharacter::StunFinished()
 {
-	GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_None);
-	bUseControllerRotationYawReplicated = false;
-	bUseControllerRotationYaw = bUseControllerRotationYawReplicated;
-	bStunned = true;
+	FCourseCombatState NewCombatState = CombatState;
+	NewCombatState.bStunned = false;
+	NewCombatState.bUseControllerRotationYaw = true;
+	SetCombatState(NewCombatState);
+}
+
+float AUECourseCharacter::GetStunTimeRemaining() const
+{
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+
+	if (!CombatState.bStunned || GameState == nullptr)
+	{
+		return 0.f;
+	}
+
+	const float Elapsed = GameState->GetServerWorldTimeSeconds() - CombatState.StunStartServerTime;
+	return FMath::Max(StunTime - Elapsed, 0.f);
+}
+
+void AUECourseCharacter::SetCombatState(const FCourseCombatState& NewCombatState)
+{
+	if (NewCombatState == CombatState)
+	{
+		return;
+	}
+
+	CombatState = NewCombatState;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AUECourseCharacter, CombatState, this);
+
+	ApplyCombatState();
 }
 
-void AUECourseCharacter::StunFinished_Implementation()
+void AUECourseCharacter::OnRep_CombatState()
 {
-	StunFinished_Multicast();
+	ApplyCombatState();
 }
 
-void AUECourseCharacter::StunFinished_Multicast_Implementation()
+// Applying the state is idempotent, so a dropped or repeated update leaves every machine in the same state
+void AUECourseCharacter::ApplyCombatState()
 {
-	GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Walking);
-	bUseControllerRotationYawReplicated = true;
+	// The owning client only ever attacks through its own predicted input
+	bAttack = GetLocalRole() == ROLE_AutonomousProxy ? bAttackPredicted : CombatState.bAttack;
+	bStunned = CombatState.bStunned;
+	bUseControllerRotationYawReplicated = CombatState.bUseControllerRotationYaw;
 	bUseControllerRotationYaw = bUseControllerRotationYawReplicated;
-	bStunned = false;
+
+	const EMovementMode MovementMode = (bAttack || bStunned) ? EMovementMode::MOVE_None : EMovementMode::MOVE_Walking;
+
+	if (GetCharacterMovement()->MovementMode != MovementMode)
+	{
+		GetCharacterMovement()->SetMovementMode(MovementMode);
+	}
 }
 
-void AUECourseCharacter::PickUp(AActor* OtherActor)
+void AUECourseCharacter::CollectPickUp(int HitPoints)
 {
-	IPickUpInterface* PickUp = Cast<IPickUpInterface>(OtherActor);
-	int TakeAHit = PickUp->Interact();
+	InvokeDamage(HitPoints);
+	OnItemCollected.Broadcast(HitPoints);
+
+	// The health arrives through CurrentHP, only the event itself has to be sent
+	if (!IsLocallyControlled())
+	{
+		ClientItemCollected(HitPoints);
+	}
+}
 
-	InvokeDamage(TakeAHit);
-	OnItemCollected.Broadcast(TakeAHit);
-	OtherActor->Destroy();
+void AUECourseCharacter::ClientItemCollected_Implementation(int HitPoints)
+{
+	OnItemCollected.Broadcast(HitPoints);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -184,33 +297,81 @@ void AUECourseCharacter::SetupPlayerInputComponent(class UInputComponent* Player
 	PlayerInputComponent->BindAction("Attack", IE_Pressed, this, &AUECourseCharacter::ClawAttack);
 }
 
-void AUECourseCharacter::ClawAttack_Implementation()
+void AUECourseCharacter::ClawAttack()
 {
-	if (ClawAttack_Validate())
+	if (!ClawAttack_Validate())
+	{
+		return;
+	}
+
+	LocalInputFrame.bAttack = true;
+
+	if (GetLocalRole() == ROLE_AutonomousProxy)
 	{
-		ClawAttack_Multicast();
+		// Start the attack right away, the server confirms or rejects it by the input sequence that carried it
+		bAttackPredicted = true;
+		bAttackAckPending = true;
+		PredictedAttackTime = GetWorld()->GetTimeSeconds();
+		PredictedAttackCount++;
+		INC_DWORD_STAT(STAT_PredictedClawAttacks);
+
+		ApplyCombatState();
 	}
 }
 
-bool AUECourseCharacter::ClawAttack_Validate()
+void AUECourseCharacter::ClientAckClawAttack_Implementation(uint16 PredictionKey, bool bAccepted)
 {
-	return !bStunned;
+	if (!bAttackAckPending || PredictionKey != PredictedAttackKey)
+	{
+		return;
+	}
+
+	bAttackAckPending = false;
+
+	if (!bAccepted)
+	{
+		RollbackPredictedAttack();
+	}
+}
+
+void AUECourseCharacter::RollbackPredictedAttack()
+{
+	MispredictedAttackCount++;
+	INC_DWORD_STAT(STAT_MispredictedClawAttacks);
+	UE_LOG(LogTemp, Log, TEXT("%s claw attack rolled back, %d of %d predicted attacks mispredicted"), *GetName(), MispredictedAttackCount, PredictedAttackCount);
+
+	bAttackPredicted = false;
+	ApplyCombatState();
 }
 
-void AUECourseCharacter::ClawAttack_Multicast_Implementation()
+bool AUECourseCharacter::ClawAttack_Validate()
 {
-	GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_None);
-	bAttack = true;
+	return !bStunned;
 }
 
 void AUECourseCharacter::ClawAttackFinished()
 {
-	GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Walking);
-	bAttack = false;
+	if (GetLocalRole() == ROLE_AutonomousProxy)
+	{
+		bAttackPredicted = false;
+		ApplyCombatState();
+		return;
+	}
+
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	FCourseCombatState NewCombatState = CombatState;
+	NewCombatState.bAttack = false;
+	SetCombatState(NewCombatState);
 }
 
 void AUECourseCharacter::Turn(float Rate)
 {
+	LocalInputFrame.Turn = FCourseInputFrame::QuantizeAxis(Rate, FCourseInputFrame::TurnAxisRange);
+
 	if (GetCharacterMovement()->MovementMode == EMovementMode::MOVE_Walking)
 	{
 		TurnInputRate = Rate;
@@ -230,63 +391,193 @@ void AUECourseCharacter::LookUp(float Rate)
 	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
 }
 
-void AUECourseCharacter::MoveForward_Implementation(float Value)
+void AUECourseCharacter::MoveForward(float Value)
 {
-	if(GetCharacterMovement()->MovementMode == EMovementMode::MOVE_Walking)
-	{
-		ForwardInputValue = Value;
+	LocalInputFrame.Forward = FCourseInputFrame::QuantizeAxis(Value, FCourseInputFrame::MoveAxisRange);
 
-		MoveForward_Client(Value);
-	}
-	else
+	// The owner skips AnimInputs replication, so it keeps its own animation value
+	ForwardInputValue = GetCharacterMovement()->MovementMode == EMovementMode::MOVE_Walking ? Value : 0.0f;
+
+	if ((Controller != nullptr) && (Value != 0.0f) && GetCharacterMovement()->MovementMode == EMovementMode::MOVE_Walking)
 	{
-		ForwardInputValue = 0.0f;
+		// find out which way is forward
+		const FRotator Rotation = Controller->GetControlRotation();
+		const FRotator YawRotation(0, Rotation.Yaw, 0);
+
+		// get forward vector, the movement component predicts it locally and the server corrects it
+		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
+		AddMovementInput(Direction, Value);
 	}
 }
 
-void AUECourseCharacter::MoveForward_Client_Implementation(float Value)
+void AUECourseCharacter::MoveRight(float Value)
 {
-	if ((Controller != nullptr) && (Value != 0.0f))
+	LocalInputFrame.Right = FCourseInputFrame::QuantizeAxis(Value, FCourseInputFrame::MoveAxisRange);
+
+	RightInputValue = GetCharacterMovement()->MovementMode == EMovementMode::MOVE_Walking ? Value : 0.0f;
+
+	if ((Controller != nullptr) && (Value != 0.0f) && GetCharacterMovement()->MovementMode == EMovementMode::MOVE_Walking)
 	{
-		// find out which way is forward
+		// find out which way is right
 		const FRotator Rotation = Controller->GetControlRotation();
 		const FRotator YawRotation(0, Rotation.Yaw, 0);
 
-		// get forward vector
-		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
+		// get right vector 
+		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
+		// add movement in that direction
 		AddMovementInput(Direction, Value);
 	}
 }
 
-void AUECourseCharacter::MoveRight_Implementation(float Value)
+void AUECourseCharacter::SendInput(float DeltaSeconds)
+{
+	if (GLogInputBandwidth != 0)
+	{
+		InputBandwidthWindow += DeltaSeconds;
+
+		if (InputBandwidthWindow >= 1.f)
+		{
+			UE_LOG(LogTemp, Log, TEXT("%s input packets: %.1f payload bytes/sec"), *GetName(), InputBytesSent / InputBandwidthWindow);
+			InputBytesSent = 0;
+			InputBandwidthWindow = 0.f;
+		}
+	}
+
+	const FCourseInputFrame Frame = LocalInputFrame;
+	LocalInputFrame.bAttack = false;
+
+	const bool bChanged = SentInput.NumFrames == 0 || !Frame.HasSameInput(SentInput.Frames[0]);
+
+	if (bChanged || !bSendInputOnlyOnChange)
+	{
+		if (Frame.bAttack)
+		{
+			PredictedAttackKey = NextInputSequence;
+		}
+
+		SentInput.Push(Frame, NextInputSequence++);
+		InputResendsLeft = FCourseInputBundle::MaxFrames - 1;
+	}
+	else if (InputResendsLeft > 0)
+	{
+		// Unchanged input is resent a few times so a lost packet does not leave the server with stale input
+		InputResendsLeft--;
+	}
+	else
+	{
+		return;
+	}
+
+	if (HasAuthority())
+	{
+		ReceiveInput(SentInput);
+		return;
+	}
+
+	ServerSendInput(SentInput);
+
+	if (GLogInputBandwidth != 0)
+	{
+		FBitWriter Writer(0, true);
+		bool bSuccess = false;
+		SentInput.NetSerialize(Writer, nullptr, bSuccess);
+		InputBytesSent += Writer.GetNumBytes();
+	}
+}
+
+void AUECourseCharacter::ServerSendInput_Implementation(const FCourseInputBundle& Bundle)
 {
-	MoveRight_Multicast(Value);
+	ReceiveInput(Bundle);
 }
 
-void AUECourseCharacter::MoveRight_Multicast_Implementation(float Value)
+void AUECourseCharacter::ReceiveInput(const FCourseInputBundle& Bundle)
 {
-	if(GetCharacterMovement()->MovementMode == EMovementMode::MOVE_Walking)
+	// Oldest frame first, so redundant frames fill the gaps left by lost packets in order
+	for (int32 i = Bundle.NumFrames - 1; i >= 0; i--)
 	{
-		RightInputValue = Value;
+		const uint16 Sequence = Bundle.GetSequence(i);
 
-		if ( (Controller != nullptr) && (Value != 0.0f) )
+		if (bReceivedInput && !FCourseInputBundle::IsNewerSequence(Sequence, LastReceivedInputSequence))
 		{
-			// find out which way is right
-			const FRotator Rotation = Controller->GetControlRotation();
-			const FRotator YawRotation(0, Rotation.Yaw, 0);
-	
-			// get right vector 
-			const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
-			// add movement in that direction
-			AddMovementInput(Direction, Value);
+			continue;
+		}
+
+		const FCourseInputFrame& Frame = Bundle.Frames[i];
+
+		if (Frame.bAttack)
+		{
+			const bool bAccepted = ClawAttack_Validate();
+
+			if (bAccepted)
+			{
+				FCourseCombatState NewCombatState = CombatState;
+				NewCombatState.bAttack = true;
+				SetCombatState(NewCombatState);
+
+				ValidateClawHit();
+			}
+
+			if (!IsLocallyControlled())
+			{
+				ClientAckClawAttack(Sequence, bAccepted);
+			}
 		}
+
+		ServerInputFrame = Frame;
+		LastReceivedInputSequence = Sequence;
+		bReceivedInput = true;
+	}
+}
+
+// Movement itself is replicated by the character movement component, the input packet only drives the animation values
+void AUECourseCharacter::ApplyInput()
+{
+	if (!bReceivedInput)
+	{
+		return;
+	}
+
+	if (GetCharacterMovement()->MovementMode == EMovementMode::MOVE_Walking)
+	{
+		SetAnimInputs(
+			FCourseInputFrame::DequantizeAxis(ServerInputFrame.Forward, FCourseInputFrame::MoveAxisRange),
+			FCourseInputFrame::DequantizeAxis(ServerInputFrame.Right, FCourseInputFrame::MoveAxisRange),
+			FCourseInputFrame::DequantizeAxis(ServerInputFrame.Turn, FCourseInputFrame::TurnAxisRange));
 	}
 	else
 	{
-		RightInputValue = 0.0f;
+		SetAnimInputs(0.0f, 0.0f, 0.0f);
+	}
+}
+
+void AUECourseCharacter::SetAnimInputs(float Forward, float Right, float Turn)
+{
+	if (!IsLocallyControlled())
+	{
+		ForwardInputValue = Forward;
+		RightInputValue = Right;
+		TurnInputRate = Turn;
+	}
+
+	FCourseAnimInputs NewAnimInputs;
+	NewAnimInputs.Forward = FCourseInputFrame::QuantizeAxis(Forward, FCourseInputFrame::MoveAxisRange);
+	NewAnimInputs.Right = FCourseInputFrame::QuantizeAxis(Right, FCourseInputFrame::MoveAxisRange);
+	NewAnimInputs.Turn = FCourseInputFrame::QuantizeAxis(Turn, FCourseInputFrame::TurnAxisRange);
+
+	if (NewAnimInputs != AnimInputs)
+	{
+		AnimInputs = NewAnimInputs;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AUECourseCharacter, AnimInputs, this);
 	}
 }
 
+void AUECourseCharacter::OnRep_AnimInputs()
+{
+	ForwardInputValue = FCourseInputFrame::DequantizeAxis(AnimInputs.Forward, FCourseInputFrame::MoveAxisRange);
+	RightInputValue = FCourseInputFrame::DequantizeAxis(AnimInputs.Right, FCourseInputFrame::MoveAxisRange);
+	TurnInputRate = FCourseInputFrame::DequantizeAxis(AnimInputs.Turn, FCourseInputFrame::TurnAxisRange);
+}
+
 void AUECourseCharacter::ShowInfo()
 {
 	TArray<AActor*> AllActorsOfClass;
@@ -295,10 +586,17 @@ void AUECourseCharacter::ShowInfo()
 	TArray<AActor*> AllActorsWithTag;
 	UWorld* World = GetWorld();
 
-	UGameplayStatics::GetAllActorsOfClass(World, ATestActor::StaticClass(), AllActorsOfClass);
-	ActorOfClass = UGameplayStatics::GetActorOfClass(World, ATestActor::StaticClass());
-	UGameplayStatics::GetAllActorsOfClassWithTag(World, ATestActor::StaticClass(), FName(TEXT("ActorOfClassTag")), AllActorsOfClassWithTag);
-	UGameplayStatics::GetAllActorsWithTag(World, FName(TEXT("ActorTag")), AllActorsWithTag);
+	UCourseActorRegistrySubsystem* Registry = World->GetSubsystem<UCourseActorRegistrySubsystem>();
+
+	if (Registry == nullptr)
+	{
+		return;
+	}
+
+	Registry->GetAllActorsOfClass(ATestActor::StaticClass(), AllActorsOfClass);
+	ActorOfClass = Registry->GetActorOfClass(ATestActor::StaticClass());
+	Registry->GetAllActorsOfClassWithTag(ATestActor::StaticClass(), FName(TEXT("ActorOfClassTag")), AllActorsOfClassWithTag);
+	Registry->GetAllActorsWithTag(FName(TEXT("ActorTag")), AllActorsWithTag);
 
 	UE_LOG(LogTemp, Warning, TEXT("GetAllActorsOfClass()"));
 	for (AActor* Actor : AllActorsOfClass)
@@ -332,35 +630,67 @@ void AUECourseCharacter::Log(FString Name, FString ClassName)
 
 int AUECourseCharacter::DealDamage()
 {
-	return FMath::FRandRange(10, 20);
+	return IFighterInterface::DealDamage();
 }
 
 void AUECourseCharacter::InvokeDamage(int Damage)
 {
-	CurrentHP -= Damage;
-	CurrentHP = FMath::Clamp(CurrentHP, 0, MaxHP);
+	UCourseDamageSubsystem::ApplyDamage(this, Damage);
+}
+
+int AUECourseCharacter::TakeDamage(int Damage)
+{
+	const int NewHP = FMath::Clamp(CurrentHP - Damage, 0, MaxHP);
+
+	if (NewHP != CurrentHP)
+	{
+		CurrentHP = NewHP;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AUECourseCharacter, CurrentHP, this);
+	}
+
+	return CurrentHP;
+}
+
+void AUECourseCharacter::OnDamageResolved(int TotalDamage, bool bKilled)
+{
+	ShowHealth(bKilled);
 
+	UE_LOG(LogTemp, Warning, TEXT("Actor take a hit for %d points"), TotalDamage);
+}
+
+void AUECourseCharacter::OnRep_CurrentHP(int OldHP)
+{
+	// Damage applied only on the server, such as pickups, reaches the client here
+	ShowHealth(OldHP > 0 && CurrentHP <= 0);
+}
+
+void AUECourseCharacter::ShowHealth(bool bKilled)
+{
 	if (PlayerHUD != nullptr)
 	{
 		PlayerHUD->SetHealth(CurrentHP, MaxHP);
 	}
 
-	if (CurrentHP <= 0)
+	if (bKilled && IsLocallyControlled())
 	{
-		UGameplayStatics::OpenLevel(GetWorld(), TEXT("LevelMenu"));
+		if (UCourseTransitionSubsystem* Transition = GetGameInstance()->GetSubsystem<UCourseTransitionSubsystem>())
+		{
+			Transition->TravelToLevel(TEXT("LevelMenu"));
+		}
 	}
-
-	UE_LOG(LogTemp, Warning, TEXT("Actor take a hit for %d points"), Damage);
 }
 
 void AUECourseCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AUECourseCharacter, ForwardInputValue);
-	DOREPLIFETIME(AUECourseCharacter, RightInputValue);
-	DOREPLIFETIME(AUECourseCharacter, TurnInputRate);
-	DOREPLIFETIME(AUECourseCharacter, bAttack);
-	DOREPLIFETIME(AUECourseCharacter, bStunned);
-	DOREPLIFETIME(AUECourseCharacter, bUseControllerRotationYawReplicated);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUECourseCharacter, CombatState, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUECourseCharacter, CurrentHP, Params);
+
+	// The owning client already knows its own input
+	Params.Condition = COND_SkipOwner;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUECourseCharacter, AnimInputs, Params);
 }
@@ -5,12 +5,15 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Delegates/Delegate.h"
+#include "Core/CourseInputPacket.h"
+#include "Core/CourseCombatState.h"
+#include "FighterInterface.h"
 #include "UECourseCharacter.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnItemCollected, int, HitPoints);
 
 UCLASS(config=Game)
-class AUECourseCharacter : public ACharacter//, public IFighterInterface
+class AUECourseCharacter : public ACharacter, public IFighterInterface
 {
 	GENERATED_BODY()
 
@@ -36,74 +39,118 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
 	float BaseLookUpRate;
 
-	UPROPERTY(VisibleAnywhere, Replicated, BlueprintReadOnly, Category = Camera)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
 	float RightInputValue;
 
-	UPROPERTY(VisibleAnywhere, Replicated, BlueprintReadOnly, Category = Camera)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
 	float ForwardInputValue;
 
-	UPROPERTY(VisibleAnywhere, Replicated, BlueprintReadOnly, Category = Camera)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
 	float TurnInputRate;
 
-	UPROPERTY(VisibleAnywhere, Replicated, BlueprintReadOnly, Category = "State")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State")
 	bool bAttack = false;
 
-	UPROPERTY(VisibleAnywhere, Replicated, BlueprintReadOnly, Category = "State")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State")
 	bool bStunned = false;
 
-	UPROPERTY(VisibleAnywhere, Replicated, BlueprintReadOnly, Category = "Character")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character")
 	bool bUseControllerRotationYawReplicated;
 
 	UPROPERTY(EditDefaultsOnly, Category = "State")
 	float StunTime = 5.f;
 
+	/** Length of the claw sweep in front of the character. */
+	UPROPERTY(EditDefaultsOnly, Category = "State")
+	float ClawReach = 120.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "State")
+	float ClawRadius = 40.f;
+
+	/** Upper bound for how far back in time a claw hit is validated. */
+	UPROPERTY(EditDefaultsOnly, Category = "Network")
+	float MaxRewindTime = 0.25f;
+
+	/** Seconds to wait for the server to confirm a predicted attack before rolling it back. */
+	UPROPERTY(EditDefaultsOnly, Category = "Network")
+	float AttackAckTimeout = 1.f;
+
+	/** Send an input packet only when the input changed, instead of every tick. */
+	UPROPERTY(EditDefaultsOnly, Category = "Network")
+	bool bSendInputOnlyOnChange = false;
+
 	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	virtual void Tick(float DeltaSeconds) override;
 	
 protected:
 	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
-	UFUNCTION(Server, Reliable)
 	void MoveForward(float Value);
-
-	UFUNCTION(Client, Reliable)
-	void MoveForward_Client(float Value);
 	
-	UFUNCTION(Server, Reliable)
 	void MoveRight(float Value);
 
-	UFUNCTION(NetMulticast, Reliable)
-	void MoveRight_Multicast(float Value);
+	// Input packet
+	UFUNCTION(Server, Unreliable)
+	void ServerSendInput(const FCourseInputBundle& Bundle);
+
+	void SendInput(float DeltaSeconds);
+
+	void ReceiveInput(const FCourseInputBundle& Bundle);
+
+	void ApplyInput();
+
+	void SetAnimInputs(float Forward, float Right, float Turn);
+
+	UFUNCTION()
+	void OnRep_AnimInputs();
 
 	// ClawAttack
-	UFUNCTION(Server, Reliable, WithValidation)
 	void ClawAttack();
 
-	UFUNCTION(NetMulticast, Reliable)
-	void ClawAttack_Multicast();
-
 	UFUNCTION(BlueprintCallable)
 	void ClawAttackFinished();
 
 	virtual bool ClawAttack_Validate();
 
+	UFUNCTION(Client, Reliable)
+	void ClientAckClawAttack(uint16 PredictionKey, bool bAccepted);
+
+	void RollbackPredictedAttack();
+
+	/** Server: stuns the fighters hit by the claw, rewound to the attacker's view time. */
+	void ValidateClawHit();
+
 	//Stun State
-	UFUNCTION(Server, Reliable)
 	void StunBegin();
 
-	UFUNCTION(NetMulticast, Reliable)
-	void StunBegin_Multicast();
-
-	UFUNCTION(Server, Reliable)
 	void StunFinished();
 
-	UFUNCTION(NetMulticast, Reliable)
-	void StunFinished_Multicast();
+	// Combat State
+	void SetCombatState(const FCourseCombatState& NewCombatState);
+
+	void ApplyCombatState();
+
+	UFUNCTION()
+	void OnRep_CombatState();
+
+	UFUNCTION()
+	void OnRep_CurrentHP(int OldHP);
+
+	/** Shows the current health on the HUD, and leaves for the menu when the locally controlled character died. */
+	void ShowHealth(bool bKilled);
 
-	UFUNCTION(Server, Reliable)
-	void StunIndicatorSpawn(FVector Location);
+	/** Lets the owning client react to a pickup the server applied. */
+	UFUNCTION(Client, Reliable)
+	void ClientItemCollected(int HitPoints);
 
-	UFUNCTION(NetMulticast, Reliable)
-	void StunIndicatorSpawn_Multicast(FVector Location);
+	void StunIndicatorSpawn(const FVector& Location);
+
+	/** Cosmetic only, so a dropped spawn request just loses one indicator. */
+	UFUNCTION(NetMulticast, Unreliable)
+	void StunIndicatorSpawn_Multicast(FVector_NetQuantize Location);
 
 	virtual bool StunBegin_Validate();
 
@@ -120,6 +167,8 @@ public:
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
+	/** Returns IndicatorClass **/
+	FORCEINLINE TSubclassOf<class AIndicator> GetIndicatorClass() const { return IndicatorClass; }
 
 	UFUNCTION(BlueprintPure, Category = "C++")
 	FORCEINLINE bool GetAttack() const { return bAttack; }
@@ -127,19 +176,28 @@ public:
 	UFUNCTION(BlueprintPure, Category = "C++")
 	FORCEINLINE bool GetStunned() const { return bStunned; }
 
+	/** Seconds of stun left, computed locally from the replicated stun start time. */
+	UFUNCTION(BlueprintPure, Category = "C++")
+	float GetStunTimeRemaining() const;
+
 	UFUNCTION(BlueprintCallable, Category = Character)
 	virtual void ShowInfo();
 
+	/** Queues the hit, it is applied together with the rest of the frame's hits. */
 	UFUNCTION(BlueprintCallable, Category = Character)
 	void InvokeDamage(int Damage);
 
 	UFUNCTION(BlueprintCallable, Category = Character)
-	int DealDamage();
+	virtual int DealDamage() override;
 
-	UFUNCTION()
-	void OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int OtherBodyIndex, bool FromSweep, const FHitResult& SweepResult);
+	// IFighterInterface
+	using ACharacter::TakeDamage;
+	virtual int TakeDamage(int Damage) override;
+	virtual bool IsAlive() const override { return CurrentHP > 0; }
+	virtual void OnDamageResolved(int TotalDamage, bool bKilled) override;
 
-	void PickUp(AActor* OtherActor);
+	/** Applies a pickup the server has validated for this character. */
+	void CollectPickUp(int HitPoints);
 
 	UPROPERTY(BlueprintAssignable, BlueprintCallable)
 	FOnItemCollected OnItemCollected;
@@ -147,7 +205,7 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	int MaxHP = 100;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_CurrentHP)
 	int CurrentHP = 100;
 
 	UPROPERTY(EditAnywhere)
@@ -159,6 +217,49 @@ public:
 private:
 	FTimerHandle StunTimerHandle;
 
+	UPROPERTY(ReplicatedUsing = OnRep_CombatState)
+	FCourseCombatState CombatState;
+
+	/** Quantized copy of the animation inputs, replicated to everyone but the owner. */
+	UPROPERTY(ReplicatedUsing = OnRep_AnimInputs)
+	FCourseAnimInputs AnimInputs;
+
+	/** Input gathered by the axis bindings this frame. */
+	FCourseInputFrame LocalInputFrame;
+
+	/** Frames already sent to the server, resent for redundancy. */
+	FCourseInputBundle SentInput;
+
+	uint16 NextInputSequence = 0;
+
+	/** How many more times the newest frame is resent when sending only on change. */
+	int32 InputResendsLeft = 0;
+
+	/** Latest input frame received by the server. */
+	FCourseInputFrame ServerInputFrame;
+
+	uint16 LastReceivedInputSequence = 0;
+
+	bool bReceivedInput = false;
+
+	/** Owning client started an attack that the server has not rejected. */
+	bool bAttackPredicted = false;
+
+	bool bAttackAckPending = false;
+
+	/** Sequence of the input frame that carried the predicted attack. */
+	uint16 PredictedAttackKey = 0;
+
+	float PredictedAttackTime = 0.f;
+
+	int32 PredictedAttackCount = 0;
+
+	int32 MispredictedAttackCount = 0;
+
+	int32 InputBytesSent = 0;
+
+	float InputBandwidthWindow = 0.f;
+
 	void Log(FString Name, FString ClassName);
 
 };
\ No newline at end of file
@@ -1,9 +1,20 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "UECourseGameMode.h"
+#include "UECourse.h"
 #include "UECourseCharacter.h"
+#include "Engine/World.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "UObject/ConstructorHelpers.h"
 
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Net Flush (ms)"), STAT_NetFlushMs, STATGROUP_UECourse);
+
+static int32 GLogReplicationTime = 0;
+static FAutoConsoleVariableRef CVarLogReplicationTime(
+	TEXT("course.Net.LogReplicationTime"),
+	GLogReplicationTime,
+	TEXT("Log the server's average and max ms per frame from the end of actor ticks to the end of the net flush, where ServerReplicateActors runs."));
+
 AUECourseGameMode::AUECourseGameMode()
 {
 	// set default pawn class to our Blueprinted character
@@ -12,6 +23,9 @@ AUECourseGameMode::AUECourseGameMode()
 	{
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
+
+	// Server travel keeps clients connected and loads the next map in the background
+	bUseSeamlessTravel = true;
 }
 
 void AUECourseGameMode::PostLogin(APlayerController* NewPlayer)
@@ -23,4 +37,66 @@ void AUECourseGameMode::PostLogin(APlayerController* NewPlayer)
 		NewPlayer->SetShowMouseCursor(true);
 		NewPlayer->SetInputMode(FInputModeGameOnly());
 	}
-}
\ No newline at end of file
+}
+void AUECourseGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &AUECourseGameMode::HandlePostActorTick);
+	PostTickFlushHandle = GetWorld()->OnPostTickFlush().AddUObject(this, &AUECourseGameMode::HandlePostTickFlush);
+}
+
+void AUECourseGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	GetWorld()->OnPostTickFlush().Remove(PostTickFlushHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AUECourseGameMode::HandlePostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld())
+	{
+		NetFlushStartTime = FPlatformTime::Seconds();
+	}
+}
+
+// Measured from the end of the actor ticks, so it also covers the little work the world does before the net flush
+void AUECourseGameMode::HandlePostTickFlush()
+{
+	if (NetFlushStartTime == 0.0)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const double FlushMs = (Now - NetFlushStartTime) * 1000.0;
+	NetFlushStartTime = 0.0;
+	SET_FLOAT_STAT(STAT_NetFlushMs, FlushMs);
+
+	if (GLogReplicationTime == 0)
+	{
+		NetFlushLogTime = 0.0;
+		return;
+	}
+
+	if (NetFlushLogTime == 0.0)
+	{
+		NetFlushLogTime = Now;
+		NetFlushTotalMs = 0.0;
+		NetFlushMaxMs = 0.0;
+		NetFlushFrames = 0;
+	}
+
+	NetFlushTotalMs += FlushMs;
+	NetFlushMaxMs = FMath::Max(NetFlushMaxMs, FlushMs);
+	NetFlushFrames++;
+
+	if (Now - NetFlushLogTime >= 1.0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Replication: %.3f ms avg, %.3f ms max per frame over %d frames, push model %s"),
+			NetFlushTotalMs / NetFlushFrames, NetFlushMaxMs, NetFlushFrames, IS_PUSH_MODEL_ENABLED() ? TEXT("on") : TEXT("off"));
+		NetFlushLogTime = 0.0;
+	}
+}
@@ -18,6 +18,24 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
 	float Hour = 0.f;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	FDelegateHandle PostActorTickHandle;
+	FDelegateHandle PostTickFlushHandle;
+
+	/** Replication timing for course.Net.LogReplicationTime. */
+	double NetFlushStartTime = 0.0;
+	double NetFlushLogTime = 0.0;
+	double NetFlushTotalMs = 0.0;
+	double NetFlushMaxMs = 0.0;
+	int32 NetFlushFrames = 0;
+
+	void HandlePostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void HandlePostTickFlush();
 };
 
 
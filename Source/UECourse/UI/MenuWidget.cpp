@@ -2,7 +2,9 @@
 
 
 #include "MenuWidget.h"
+#include "Engine/GameInstance.h"
 #include "Kismet/GameplayStatics.h"
+#include "../Core/CourseTransitionSubsystem.h"
 
 void UMenuWidget::NativeConstruct()
 {
@@ -25,5 +27,8 @@ void UMenuWidget::OnChangeBackground()
 
 void UMenuWidget::OnPlay()
 {
-	UGameplayStatics::OpenLevel(GetWorld(), TEXT("MainLevel"));
+	if (UCourseTransitionSubsystem* Transition = GetGameInstance()->GetSubsystem<UCourseTransitionSubsystem>())
+	{
+		Transition->TravelToLevel(TEXT("MainLevel"));
+	}
 }
\ No newline at end of file